@@ -152,6 +152,28 @@ namespace siv
 		[[nodiscard]]
 		value_type noise3D(value_type x, value_type y, value_type z) const noexcept;
 
+		///////////////////////////////////////
+		//
+		//	Noise with analytic partial derivatives ({ value, d/dx, d/dy[, d/dz] })
+		//
+
+		[[nodiscard]]
+		std::array<value_type, 3> noise2D_deriv(value_type x, value_type y) const noexcept;
+
+		[[nodiscard]]
+		std::array<value_type, 4> noise3D_deriv(value_type x, value_type y, value_type z) const noexcept;
+
+		///////////////////////////////////////
+		//
+		//	Curl noise (Divergence-free flow vectors)
+		//
+
+		[[nodiscard]]
+		std::array<value_type, 2> curl2D(value_type x, value_type y) const noexcept;
+
+		[[nodiscard]]
+		std::array<value_type, 3> curl3D(value_type x, value_type y, value_type z) const noexcept;
+
 		///////////////////////////////////////
 		//
 		//	Noise (The result is remapped to the range [0, 1])
@@ -283,6 +305,14 @@ namespace siv
 			return t * t * t * (t * (t * 6 - 15) + 10);
 		}
 
+		// d/dt of Fade, 30t^2(t - 1)^2
+		template <class Float>
+		[[nodiscard]]
+		inline constexpr Float FadeDerivative(const Float t) noexcept
+		{
+			return t * t * (t * (t * 30 - 60) + 30);
+		}
+
 		template <class Float>
 		[[nodiscard]]
 		inline constexpr Float Lerp(const Float a, const Float b, const Float t) noexcept
@@ -300,6 +330,22 @@ namespace siv
 			return ((h & 1) == 0 ? u : -u) + ((h & 2) == 0 ? v : -v);
 		}
 
+		// The 16 directions Grad picks from, the 12 cube edge midpoints with four repeated
+		template <class Float>
+		inline constexpr Float Gradients[16][3] = {
+			{ 1, 1, 0 }, { -1, 1, 0 }, { 1, -1, 0 }, { -1, -1, 0 },
+			{ 1, 0, 1 }, { -1, 0, 1 }, { 1, 0, -1 }, { -1, 0, -1 },
+			{ 0, 1, 1 }, { 0, -1, 1 }, { 0, 1, -1 }, { 0, -1, -1 },
+			{ 1, 1, 0 }, { 0, -1, 1 }, { -1, 1, 0 }, { 0, -1, -1 },
+		};
+
+		// Offsets of the second and third potential in curl3D, far enough apart to be uncorrelated
+		template <class Float>
+		inline constexpr Float CurlOffsets[2][3] = {
+			{ Float(31.416), Float(-47.853), Float(12.793) },
+			{ Float(-19.871), Float(71.113), Float(-42.377) },
+		};
+
 		template <class Float>
 		[[nodiscard]]
 		inline constexpr Float Remap_01(const Float x) noexcept
@@ -535,6 +581,119 @@ namespace siv
 
 	///////////////////////////////////////
 
+	template <class Float>
+	inline std::array<typename BasicPerlinNoise<Float>::value_type, 3> BasicPerlinNoise<Float>::noise2D_deriv(const value_type x, const value_type y) const noexcept
+	{
+		const std::array<value_type, 4> d = noise3D_deriv(x,
+			y,
+			static_cast<value_type>(SIVPERLIN_DEFAULT_Z));
+
+		return{ d[0], d[1], d[2] };
+	}
+
+	template <class Float>
+	inline std::array<typename BasicPerlinNoise<Float>::value_type, 4> BasicPerlinNoise<Float>::noise3D_deriv(const value_type x, const value_type y, const value_type z) const noexcept
+	{
+		const value_type _x = std::floor(x);
+		const value_type _y = std::floor(y);
+		const value_type _z = std::floor(z);
+
+		const std::int32_t ix = static_cast<std::int32_t>(_x) & 255;
+		const std::int32_t iy = static_cast<std::int32_t>(_y) & 255;
+		const std::int32_t iz = static_cast<std::int32_t>(_z) & 255;
+
+		const value_type fx = (x - _x);
+		const value_type fy = (y - _y);
+		const value_type fz = (z - _z);
+
+		const value_type u = perlin_detail::Fade(fx);
+		const value_type v = perlin_detail::Fade(fy);
+		const value_type w = perlin_detail::Fade(fz);
+
+		const std::uint8_t A = (m_permutation[ix & 255] + iy) & 255;
+		const std::uint8_t B = (m_permutation[(ix + 1) & 255] + iy) & 255;
+
+		const std::uint8_t AA = (m_permutation[A] + iz) & 255;
+		const std::uint8_t AB = (m_permutation[(A + 1) & 255] + iz) & 255;
+
+		const std::uint8_t BA = (m_permutation[B] + iz) & 255;
+		const std::uint8_t BB = (m_permutation[(B + 1) & 255] + iz) & 255;
+
+		// Same corners as noise3D, with the gradient vectors kept for the derivative
+		const value_type* g0 = perlin_detail::Gradients<value_type>[m_permutation[AA] & 15];
+		const value_type* g1 = perlin_detail::Gradients<value_type>[m_permutation[BA] & 15];
+		const value_type* g2 = perlin_detail::Gradients<value_type>[m_permutation[AB] & 15];
+		const value_type* g3 = perlin_detail::Gradients<value_type>[m_permutation[BB] & 15];
+		const value_type* g4 = perlin_detail::Gradients<value_type>[m_permutation[(AA + 1) & 255] & 15];
+		const value_type* g5 = perlin_detail::Gradients<value_type>[m_permutation[(BA + 1) & 255] & 15];
+		const value_type* g6 = perlin_detail::Gradients<value_type>[m_permutation[(AB + 1) & 255] & 15];
+		const value_type* g7 = perlin_detail::Gradients<value_type>[m_permutation[(BB + 1) & 255] & 15];
+
+		const value_type p0 = g0[0] * fx + g0[1] * fy + g0[2] * fz;
+		const value_type p1 = g1[0] * (fx - 1) + g1[1] * fy + g1[2] * fz;
+		const value_type p2 = g2[0] * fx + g2[1] * (fy - 1) + g2[2] * fz;
+		const value_type p3 = g3[0] * (fx - 1) + g3[1] * (fy - 1) + g3[2] * fz;
+		const value_type p4 = g4[0] * fx + g4[1] * fy + g4[2] * (fz - 1);
+		const value_type p5 = g5[0] * (fx - 1) + g5[1] * fy + g5[2] * (fz - 1);
+		const value_type p6 = g6[0] * fx + g6[1] * (fy - 1) + g6[2] * (fz - 1);
+		const value_type p7 = g7[0] * (fx - 1) + g7[1] * (fy - 1) + g7[2] * (fz - 1);
+
+		const value_type q0 = perlin_detail::Lerp(p0, p1, u);
+		const value_type q1 = perlin_detail::Lerp(p2, p3, u);
+		const value_type q2 = perlin_detail::Lerp(p4, p5, u);
+		const value_type q3 = perlin_detail::Lerp(p6, p7, u);
+
+		const value_type r0 = perlin_detail::Lerp(q0, q1, v);
+		const value_type r1 = perlin_detail::Lerp(q2, q3, v);
+
+		// Product rule, the corner gradients blended with the same weights as the corner values,
+		// plus the change of the weights themselves through Fade
+		std::array<value_type, 4> result{ perlin_detail::Lerp(r0, r1, w) };
+
+		const value_type du = perlin_detail::FadeDerivative(fx);
+		const value_type dv = perlin_detail::FadeDerivative(fy);
+		const value_type dw = perlin_detail::FadeDerivative(fz);
+
+		const value_type dnu = perlin_detail::Lerp(perlin_detail::Lerp(p1 - p0, p3 - p2, v), perlin_detail::Lerp(p5 - p4, p7 - p6, v), w);
+		const value_type dnv = perlin_detail::Lerp(q1 - q0, q3 - q2, w);
+		const value_type dnw = (r1 - r0);
+		const value_type dn[3] = { du * dnu, dv * dnv, dw * dnw };
+
+		for (int i = 0; i < 3; ++i)
+		{
+			const value_type a = perlin_detail::Lerp(perlin_detail::Lerp(g0[i], g1[i], u), perlin_detail::Lerp(g2[i], g3[i], u), v);
+			const value_type b = perlin_detail::Lerp(perlin_detail::Lerp(g4[i], g5[i], u), perlin_detail::Lerp(g6[i], g7[i], u), v);
+			result[i + 1] = perlin_detail::Lerp(a, b, w) + dn[i];
+		}
+
+		return result;
+	}
+
+	///////////////////////////////////////
+
+	template <class Float>
+	inline std::array<typename BasicPerlinNoise<Float>::value_type, 2> BasicPerlinNoise<Float>::curl2D(const value_type x, const value_type y) const noexcept
+	{
+		// The noise as a stream function, its gradient turned by 90 degrees
+		const std::array<value_type, 3> d = noise2D_deriv(x, y);
+
+		return{ d[2], -d[1] };
+	}
+
+	template <class Float>
+	inline std::array<typename BasicPerlinNoise<Float>::value_type, 3> BasicPerlinNoise<Float>::curl3D(const value_type x, const value_type y, const value_type z) const noexcept
+	{
+		// Vector potential from three offset copies of the field
+		using perlin_detail::CurlOffsets;
+		const std::array<value_type, 4> a = noise3D_deriv(x, y, z);
+		const std::array<value_type, 4> b = noise3D_deriv(x + CurlOffsets<value_type>[0][0], y + CurlOffsets<value_type>[0][1], z + CurlOffsets<value_type>[0][2]);
+		const std::array<value_type, 4> c = noise3D_deriv(x + CurlOffsets<value_type>[1][0], y + CurlOffsets<value_type>[1][1], z + CurlOffsets<value_type>[1][2]);
+
+		return{ c[2] - b[3], a[3] - c[1], b[1] - a[2] };
+	}
+
+	///////////////////////////////////////
+
 	template <class Float>
 	inline typename BasicPerlinNoise<Float>::value_type BasicPerlinNoise<Float>::noise1D_01(const value_type x) const noexcept
 	{
@@ -0,0 +1,539 @@
+//---------------------Simplex noise with the siv::BasicPerlinNoise interface---------------------------
+//
+//	Drop-in alternative to siv::BasicPerlinNoise: same seeding, state, serialization and octave
+//	helpers, and a permutation state that can be moved between the two. Classic Perlin noise2D
+//	is noise3D at a fixed z and blends the 8 corners of a cube, simplex sums the contributions of
+//	the 3 corners of a triangle in 2D and the 4 corners of a tetrahedron in 3D, with no
+//	interpolation step. The fields differ in look, simplex has no axis aligned artefacts.
+//
+
+# pragma once
+# include "PerlinNoise.hpp"
+# include <cmath>
+
+// [[nodiscard]] for constructors
+# if (201907L <= __has_cpp_attribute(nodiscard))
+#	define SIVSIMPLEX_NODISCARD_CXX20 [[nodiscard]]
+# else
+#	define SIVSIMPLEX_NODISCARD_CXX20
+# endif
+
+// std::uniform_random_bit_generator concept
+# if __cpp_lib_concepts
+#	define SIVSIMPLEX_CONCEPT_URBG  template <std::uniform_random_bit_generator URBG>
+#	define SIVSIMPLEX_CONCEPT_URBG_ template <std::uniform_random_bit_generator URBG>
+# else
+#	define SIVSIMPLEX_CONCEPT_URBG  template <class URBG, std::enable_if_t<std::conjunction_v<std::is_invocable<URBG&>, std::is_unsigned<std::invoke_result_t<URBG&>>>>* = nullptr>
+#	define SIVSIMPLEX_CONCEPT_URBG_ template <class URBG, std::enable_if_t<std::conjunction_v<std::is_invocable<URBG&>, std::is_unsigned<std::invoke_result_t<URBG&>>>>*>
+# endif
+
+
+namespace siv
+{
+	template <class Float>
+	class BasicSimplexNoise
+	{
+	public:
+
+		static_assert(std::is_floating_point_v<Float>);
+
+		///////////////////////////////////////
+		//
+		//	Typedefs
+		//
+
+		using state_type = std::array<std::uint8_t, 256>;
+
+		using value_type = Float;
+
+		using default_random_engine = std::mt19937;
+
+		using seed_type = typename default_random_engine::result_type;
+
+		///////////////////////////////////////
+		//
+		//	Constructors
+		//
+
+		SIVSIMPLEX_NODISCARD_CXX20
+		constexpr BasicSimplexNoise() noexcept;
+
+		SIVSIMPLEX_NODISCARD_CXX20
+		explicit BasicSimplexNoise(seed_type seed);
+
+		SIVSIMPLEX_CONCEPT_URBG
+		SIVSIMPLEX_NODISCARD_CXX20
+		explicit BasicSimplexNoise(URBG&& urbg);
+
+		///////////////////////////////////////
+		//
+		//	Reseed
+		//
+
+		void reseed(seed_type seed);
+
+		SIVSIMPLEX_CONCEPT_URBG
+		void reseed(URBG&& urbg);
+
+		///////////////////////////////////////
+		//
+		//	Serialization
+		//
+
+		[[nodiscard]]
+		constexpr const state_type& serialize() const noexcept;
+
+		constexpr void deserialize(const state_type& state) noexcept;
+
+		///////////////////////////////////////
+		//
+		//	Noise (The result is in the range [-1, 1])
+		//
+
+		[[nodiscard]]
+		value_type noise1D(value_type x) const noexcept;
+
+		[[nodiscard]]
+		value_type noise2D(value_type x, value_type y) const noexcept;
+
+		[[nodiscard]]
+		value_type noise3D(value_type x, value_type y, value_type z) const noexcept;
+
+		///////////////////////////////////////
+		//
+		//	Noise (The result is remapped to the range [0, 1])
+		//
+
+		[[nodiscard]]
+		value_type noise1D_01(value_type x) const noexcept;
+
+		[[nodiscard]]
+		value_type noise2D_01(value_type x, value_type y) const noexcept;
+
+		[[nodiscard]]
+		value_type noise3D_01(value_type x, value_type y, value_type z) const noexcept;
+
+		///////////////////////////////////////
+		//
+		//	Octave noise (The result can be out of the range [-1, 1])
+		//
+
+		[[nodiscard]]
+		value_type octave1D(value_type x, std::int32_t octaves, value_type persistence = value_type(0.5)) const noexcept;
+
+		[[nodiscard]]
+		value_type octave2D(value_type x, value_type y, std::int32_t octaves, value_type persistence = value_type(0.5)) const noexcept;
+
+		[[nodiscard]]
+		value_type octave3D(value_type x, value_type y, value_type z, std::int32_t octaves, value_type persistence = value_type(0.5)) const noexcept;
+
+		///////////////////////////////////////
+		//
+		//	Octave noise (The result is clamped to the range [-1, 1])
+		//
+
+		[[nodiscard]]
+		value_type octave1D_11(value_type x, std::int32_t octaves, value_type persistence = value_type(0.5)) const noexcept;
+
+		[[nodiscard]]
+		value_type octave2D_11(value_type x, value_type y, std::int32_t octaves, value_type persistence = value_type(0.5)) const noexcept;
+
+		[[nodiscard]]
+		value_type octave3D_11(value_type x, value_type y, value_type z, std::int32_t octaves, value_type persistence = value_type(0.5)) const noexcept;
+
+		///////////////////////////////////////
+		//
+		//	Octave noise (The result is clamped and remapped to the range [0, 1])
+		//
+
+		[[nodiscard]]
+		value_type octave1D_01(value_type x, std::int32_t octaves, value_type persistence = value_type(0.5)) const noexcept;
+
+		[[nodiscard]]
+		value_type octave2D_01(value_type x, value_type y, std::int32_t octaves, value_type persistence = value_type(0.5)) const noexcept;
+
+		[[nodiscard]]
+		value_type octave3D_01(value_type x, value_type y, value_type z, std::int32_t octaves, value_type persistence = value_type(0.5)) const noexcept;
+
+		///////////////////////////////////////
+		//
+		//	Octave noise (The result is normalized to the range [-1, 1])
+		//
+
+		[[nodiscard]]
+		value_type normalizedOctave1D(value_type x, std::int32_t octaves, value_type persistence = value_type(0.5)) const noexcept;
+
+		[[nodiscard]]
+		value_type normalizedOctave2D(value_type x, value_type y, std::int32_t octaves, value_type persistence = value_type(0.5)) const noexcept;
+
+		[[nodiscard]]
+		value_type normalizedOctave3D(value_type x, value_type y, value_type z, std::int32_t octaves, value_type persistence = value_type(0.5)) const noexcept;
+
+		///////////////////////////////////////
+		//
+		//	Octave noise (The result is normalized and remapped to the range [0, 1])
+		//
+
+		[[nodiscard]]
+		value_type normalizedOctave1D_01(value_type x, std::int32_t octaves, value_type persistence = value_type(0.5)) const noexcept;
+
+		[[nodiscard]]
+		value_type normalizedOctave2D_01(value_type x, value_type y, std::int32_t octaves, value_type persistence = value_type(0.5)) const noexcept;
+
+		[[nodiscard]]
+		value_type normalizedOctave3D_01(value_type x, value_type y, value_type z, std::int32_t octaves, value_type persistence = value_type(0.5)) const noexcept;
+
+	private:
+
+		[[nodiscard]]
+		constexpr std::uint8_t hash(std::int32_t i, std::int32_t j) const noexcept;
+
+		[[nodiscard]]
+		constexpr std::uint8_t hash(std::int32_t i, std::int32_t j, std::int32_t k) const noexcept;
+
+		state_type m_permutation;
+	};
+
+	using SimplexNoise = BasicSimplexNoise<double>;
+
+	namespace simplex_detail
+	{
+		// Skew into the simplex grid and unskew back, (sqrt(n + 1) - 1) / n and (1 - 1 / sqrt(n + 1)) / n
+		template <class Float>
+		inline constexpr Float F2 = Float(0.36602540378443864676);
+
+		template <class Float>
+		inline constexpr Float G2 = Float(0.21132486540518711775);
+
+		template <class Float>
+		inline constexpr Float F3 = Float(1.0 / 3.0);
+
+		template <class Float>
+		inline constexpr Float G3 = Float(1.0 / 6.0);
+
+		// 8 directions of length sqrt(5), off the axes and diagonals, which keeps the 2D field free of a
+		// visible grid. Looked up rather than selected with ternaries, those compile to branches that
+		// mispredict per corner.
+		template <class Float>
+		inline constexpr Float Gradients2[8][2] = {
+			{ 1, 2 }, { -1, 2 }, { 1, -2 }, { -1, -2 },
+			{ 2, 1 }, { 2, -1 }, { -2, 1 }, { -2, -1 },
+		};
+
+		template <class Float>
+		[[nodiscard]]
+		inline constexpr Float Grad2(const std::uint8_t hash, const Float x, const Float y) noexcept
+		{
+			const Float* g = Gradients2<Float>[hash & 7];
+			return g[0] * x + g[1] * y;
+		}
+
+		template <class Float>
+		[[nodiscard]]
+		inline constexpr Float Grad3(const std::uint8_t hash, const Float x, const Float y, const Float z) noexcept
+		{
+			const Float* g = perlin_detail::Gradients<Float>[hash & 15];
+			return g[0] * x + g[1] * y + g[2] * z;
+		}
+
+		// std::floor is a libm call unless SSE4.1 is enabled, the truncation fix up is not
+		template <class Float>
+		[[nodiscard]]
+		inline constexpr std::int32_t FastFloor(const Float x) noexcept
+		{
+			const std::int32_t i = static_cast<std::int32_t>(x);
+			return i - (x < static_cast<Float>(i));
+		}
+
+		// Radially symmetric falloff of one corner, zero at and beyond the radius
+		template <class Float>
+		[[nodiscard]]
+		inline constexpr Float Falloff(const Float radiusSquared, const Float distanceSquared) noexcept
+		{
+			// max(d, 0) as arithmetic, GCC turns the comparison into a branch that mispredicts per corner
+			const Float d = radiusSquared - distanceSquared;
+			const Float t = (d + std::abs(d)) * Float(0.5);
+			return (t * t) * (t * t);
+		}
+	}
+
+	///////////////////////////////////////
+
+	template <class Float>
+	inline constexpr BasicSimplexNoise<Float>::BasicSimplexNoise() noexcept
+		: m_permutation{ BasicPerlinNoise<Float>{}.serialize() } {}
+
+	template <class Float>
+	inline BasicSimplexNoise<Float>::BasicSimplexNoise(const seed_type seed)
+	{
+		reseed(seed);
+	}
+
+	template <class Float>
+	SIVSIMPLEX_CONCEPT_URBG_
+	inline BasicSimplexNoise<Float>::BasicSimplexNoise(URBG&& urbg)
+	{
+		reseed(std::forward<URBG>(urbg));
+	}
+
+	///////////////////////////////////////
+
+	template <class Float>
+	inline void BasicSimplexNoise<Float>::reseed(const seed_type seed)
+	{
+		reseed(default_random_engine{ seed });
+	}
+
+	template <class Float>
+	SIVSIMPLEX_CONCEPT_URBG_
+	inline void BasicSimplexNoise<Float>::reseed(URBG&& urbg)
+	{
+		std::iota(m_permutation.begin(), m_permutation.end(), uint8_t{ 0 });
+
+		perlin_detail::Shuffle(m_permutation.begin(), m_permutation.end(), std::forward<URBG>(urbg));
+	}
+
+	///////////////////////////////////////
+
+	template <class Float>
+	inline constexpr const typename BasicSimplexNoise<Float>::state_type& BasicSimplexNoise<Float>::serialize() const noexcept
+	{
+		return m_permutation;
+	}
+
+	template <class Float>
+	inline constexpr void BasicSimplexNoise<Float>::deserialize(const state_type& state) noexcept
+	{
+		m_permutation = state;
+	}
+
+	///////////////////////////////////////
+
+	template <class Float>
+	inline constexpr std::uint8_t BasicSimplexNoise<Float>::hash(const std::int32_t i, const std::int32_t j) const noexcept
+	{
+		return m_permutation[(i + m_permutation[j & 255]) & 255];
+	}
+
+	template <class Float>
+	inline constexpr std::uint8_t BasicSimplexNoise<Float>::hash(const std::int32_t i, const std::int32_t j, const std::int32_t k) const noexcept
+	{
+		return m_permutation[(i + m_permutation[(j + m_permutation[k & 255]) & 255]) & 255];
+	}
+
+	///////////////////////////////////////
+
+	template <class Float>
+	inline typename BasicSimplexNoise<Float>::value_type BasicSimplexNoise<Float>::noise1D(const value_type x) const noexcept
+	{
+		return noise2D(x,
+			static_cast<value_type>(SIVPERLIN_DEFAULT_Y));
+	}
+
+	template <class Float>
+	inline typename BasicSimplexNoise<Float>::value_type BasicSimplexNoise<Float>::noise2D(const value_type x, const value_type y) const noexcept
+	{
+		using namespace simplex_detail;
+
+		// Cell of the skewed grid, then which of its two triangles holds the point
+		const value_type s = (x + y) * F2<Float>;
+		const std::int32_t i = FastFloor(x + s);
+		const std::int32_t j = FastFloor(y + s);
+		const value_type _i = static_cast<value_type>(i);
+		const value_type _j = static_cast<value_type>(j);
+		const value_type t = (_i + _j) * G2<Float>;
+
+		const value_type x0 = x - (_i - t);
+		const value_type y0 = y - (_j - t);
+
+		const std::int32_t i1 = x0 > y0 ? 1 : 0;
+		const std::int32_t j1 = 1 - i1;
+
+		const value_type x1 = x0 - i1 + G2<Float>;
+		const value_type y1 = y0 - j1 + G2<Float>;
+		const value_type x2 = x0 - 1 + 2 * G2<Float>;
+		const value_type y2 = y0 - 1 + 2 * G2<Float>;
+
+		const value_type n0 = Falloff(value_type(0.5), x0 * x0 + y0 * y0) * Grad2(hash(i, j), x0, y0);
+		const value_type n1 = Falloff(value_type(0.5), x1 * x1 + y1 * y1) * Grad2(hash(i + i1, j + j1), x1, y1);
+		const value_type n2 = Falloff(value_type(0.5), x2 * x2 + y2 * y2) * Grad2(hash(i + 1, j + 1), x2, y2);
+
+		// Scales the sum of the three corners to [-1, 1]
+		return value_type(45.23) * (n0 + n1 + n2);
+	}
+
+	template <class Float>
+	inline typename BasicSimplexNoise<Float>::value_type BasicSimplexNoise<Float>::noise3D(const value_type x, const value_type y, const value_type z) const noexcept
+	{
+		using namespace simplex_detail;
+
+		const value_type s = (x + y + z) * F3<Float>;
+		const std::int32_t i = FastFloor(x + s);
+		const std::int32_t j = FastFloor(y + s);
+		const std::int32_t k = FastFloor(z + s);
+		const value_type _i = static_cast<value_type>(i);
+		const value_type _j = static_cast<value_type>(j);
+		const value_type _k = static_cast<value_type>(k);
+		const value_type t = (_i + _j + _k) * G3<Float>;
+
+		const value_type x0 = x - (_i - t);
+		const value_type y0 = y - (_j - t);
+		const value_type z0 = z - (_k - t);
+
+		// The cube splits into six tetrahedra, the order of the offsets picks the one holding the
+		// point. Taken from three comparisons without branches, the order is random per sample.
+		const std::int32_t xy = x0 >= y0;
+		const std::int32_t xz = x0 >= z0;
+		const std::int32_t yz = y0 >= z0;
+		const std::int32_t i1 = xy & xz;
+		const std::int32_t j1 = (1 - xy) & yz;
+		const std::int32_t k1 = (1 - xz) & (1 - yz);
+		const std::int32_t i2 = xy | xz;
+		const std::int32_t j2 = (1 - xy) | yz;
+		const std::int32_t k2 = (1 - xz) | (1 - yz);
+
+		const value_type x1 = x0 - i1 + G3<Float>;
+		const value_type y1 = y0 - j1 + G3<Float>;
+		const value_type z1 = z0 - k1 + G3<Float>;
+		const value_type x2 = x0 - i2 + 2 * G3<Float>;
+		const value_type y2 = y0 - j2 + 2 * G3<Float>;
+		const value_type z2 = z0 - k2 + 2 * G3<Float>;
+		const value_type x3 = x0 - 1 + 3 * G3<Float>;
+		const value_type y3 = y0 - 1 + 3 * G3<Float>;
+		const value_type z3 = z0 - 1 + 3 * G3<Float>;
+
+		const value_type n0 = Falloff(value_type(0.5), x0 * x0 + y0 * y0 + z0 * z0) * Grad3(hash(i, j, k), x0, y0, z0);
+		const value_type n1 = Falloff(value_type(0.5), x1 * x1 + y1 * y1 + z1 * z1) * Grad3(hash(i + i1, j + j1, k + k1), x1, y1, z1);
+		const value_type n2 = Falloff(value_type(0.5), x2 * x2 + y2 * y2 + z2 * z2) * Grad3(hash(i + i2, j + j2, k + k2), x2, y2, z2);
+		const value_type n3 = Falloff(value_type(0.5), x3 * x3 + y3 * y3 + z3 * z3) * Grad3(hash(i + 1, j + 1, k + 1), x3, y3, z3);
+
+		// r^2 = 0.5 is the largest radius at which a corner has faded out before it leaves the simplex,
+		// 0.6 leaves a step at every simplex boundary. The largest sum found by search is 0.013007,
+		// the scale keeps the result in [-1, 1].
+		return value_type(76.8) * (n0 + n1 + n2 + n3);
+	}
+
+	///////////////////////////////////////
+
+	template <class Float>
+	inline typename BasicSimplexNoise<Float>::value_type BasicSimplexNoise<Float>::noise1D_01(const value_type x) const noexcept
+	{
+		return perlin_detail::Remap_01(noise1D(x));
+	}
+
+	template <class Float>
+	inline typename BasicSimplexNoise<Float>::value_type BasicSimplexNoise<Float>::noise2D_01(const value_type x, const value_type y) const noexcept
+	{
+		return perlin_detail::Remap_01(noise2D(x, y));
+	}
+
+	template <class Float>
+	inline typename BasicSimplexNoise<Float>::value_type BasicSimplexNoise<Float>::noise3D_01(const value_type x, const value_type y, const value_type z) const noexcept
+	{
+		return perlin_detail::Remap_01(noise3D(x, y, z));
+	}
+
+	///////////////////////////////////////
+
+	template <class Float>
+	inline typename BasicSimplexNoise<Float>::value_type BasicSimplexNoise<Float>::octave1D(const value_type x, const std::int32_t octaves, const value_type persistence) const noexcept
+	{
+		return perlin_detail::Octave1D(*this, x, octaves, persistence);
+	}
+
+	template <class Float>
+	inline typename BasicSimplexNoise<Float>::value_type BasicSimplexNoise<Float>::octave2D(const value_type x, const value_type y, const std::int32_t octaves, const value_type persistence) const noexcept
+	{
+		return perlin_detail::Octave2D(*this, x, y, octaves, persistence);
+	}
+
+	template <class Float>
+	inline typename BasicSimplexNoise<Float>::value_type BasicSimplexNoise<Float>::octave3D(const value_type x, const value_type y, const value_type z, const std::int32_t octaves, const value_type persistence) const noexcept
+	{
+		return perlin_detail::Octave3D(*this, x, y, z, octaves, persistence);
+	}
+
+	///////////////////////////////////////
+
+	template <class Float>
+	inline typename BasicSimplexNoise<Float>::value_type BasicSimplexNoise<Float>::octave1D_11(const value_type x, const std::int32_t octaves, const value_type persistence) const noexcept
+	{
+		return perlin_detail::Clamp_11(octave1D(x, octaves, persistence));
+	}
+
+	template <class Float>
+	inline typename BasicSimplexNoise<Float>::value_type BasicSimplexNoise<Float>::octave2D_11(const value_type x, const value_type y, const std::int32_t octaves, const value_type persistence) const noexcept
+	{
+		return perlin_detail::Clamp_11(octave2D(x, y, octaves, persistence));
+	}
+
+	template <class Float>
+	inline typename BasicSimplexNoise<Float>::value_type BasicSimplexNoise<Float>::octave3D_11(const value_type x, const value_type y, const value_type z, const std::int32_t octaves, const value_type persistence) const noexcept
+	{
+		return perlin_detail::Clamp_11(octave3D(x, y, z, octaves, persistence));
+	}
+
+	///////////////////////////////////////
+
+	template <class Float>
+	inline typename BasicSimplexNoise<Float>::value_type BasicSimplexNoise<Float>::octave1D_01(const value_type x, const std::int32_t octaves, const value_type persistence) const noexcept
+	{
+		return perlin_detail::RemapClamp_01(octave1D(x, octaves, persistence));
+	}
+
+	template <class Float>
+	inline typename BasicSimplexNoise<Float>::value_type BasicSimplexNoise<Float>::octave2D_01(const value_type x, const value_type y, const std::int32_t octaves, const value_type persistence) const noexcept
+	{
+		return perlin_detail::RemapClamp_01(octave2D(x, y, octaves, persistence));
+	}
+
+	template <class Float>
+	inline typename BasicSimplexNoise<Float>::value_type BasicSimplexNoise<Float>::octave3D_01(const value_type x, const value_type y, const value_type z, const std::int32_t octaves, const value_type persistence) const noexcept
+	{
+		return perlin_detail::RemapClamp_01(octave3D(x, y, z, octaves, persistence));
+	}
+
+	///////////////////////////////////////
+
+	template <class Float>
+	inline typename BasicSimplexNoise<Float>::value_type BasicSimplexNoise<Float>::normalizedOctave1D(const value_type x, const std::int32_t octaves, const value_type persistence) const noexcept
+	{
+		return (octave1D(x, octaves, persistence) / perlin_detail::MaxAmplitude(octaves, persistence));
+	}
+
+	template <class Float>
+	inline typename BasicSimplexNoise<Float>::value_type BasicSimplexNoise<Float>::normalizedOctave2D(const value_type x, const value_type y, const std::int32_t octaves, const value_type persistence) const noexcept
+	{
+		return (octave2D(x, y, octaves, persistence) / perlin_detail::MaxAmplitude(octaves, persistence));
+	}
+
+	template <class Float>
+	inline typename BasicSimplexNoise<Float>::value_type BasicSimplexNoise<Float>::normalizedOctave3D(const value_type x, const value_type y, const value_type z, const std::int32_t octaves, const value_type persistence) const noexcept
+	{
+		return (octave3D(x, y, z, octaves, persistence) / perlin_detail::MaxAmplitude(octaves, persistence));
+	}
+
+	///////////////////////////////////////
+
+	template <class Float>
+	inline typename BasicSimplexNoise<Float>::value_type BasicSimplexNoise<Float>::normalizedOctave1D_01(const value_type x, const std::int32_t octaves, const value_type persistence) const noexcept
+	{
+		return perlin_detail::Remap_01(normalizedOctave1D(x, octaves, persistence));
+	}
+
+	template <class Float>
+	inline typename BasicSimplexNoise<Float>::value_type BasicSimplexNoise<Float>::normalizedOctave2D_01(const value_type x, const value_type y, const std::int32_t octaves, const value_type persistence) const noexcept
+	{
+		return perlin_detail::Remap_01(normalizedOctave2D(x, y, octaves, persistence));
+	}
+
+	template <class Float>
+	inline typename BasicSimplexNoise<Float>::value_type BasicSimplexNoise<Float>::normalizedOctave3D_01(const value_type x, const value_type y, const value_type z, const std::int32_t octaves, const value_type persistence) const noexcept
+	{
+		return perlin_detail::Remap_01(normalizedOctave3D(x, y, z, octaves, persistence));
+	}
+}
+
+# undef SIVSIMPLEX_NODISCARD_CXX20
+# undef SIVSIMPLEX_CONCEPT_URBG
+# undef SIVSIMPLEX_CONCEPT_URBG_
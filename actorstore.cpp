@@ -0,0 +1,158 @@
+//---------------------Structure of arrays store for audio actors---------------------------
+#include "actorstore.h"
+#include "fasttrig.h"
+#include <algorithm>
+#include <cmath>
+
+namespace
+{
+    const int hexagonTriangles = 4;
+    const int verticesPerActor = hexagonTriangles * 3;
+
+    // Unit hexagon split into a fan of 4 triangles around corner 0
+    const float hexagonX[6] = { 1.f, 0.5f, -0.5f, -1.f, -0.5f, 0.5f };
+    const float hexagonY[6] = { 0.f, 0.8660254f, 0.8660254f, 0.f, -0.8660254f, -0.8660254f };
+}
+
+std::size_t ActorStore::Add(sf::Vector2f position, sf::Vector2f velocity, float actorRadius, sf::Color actorColor, ActorEmitterState state)
+{
+    posX.push_back(position.x);
+    posY.push_back(position.y);
+    velX.push_back(velocity.x);
+    velY.push_back(velocity.y);
+    radius.push_back(actorRadius);
+    listenerDistance.push_back(0.f);
+    inFocus.push_back(0);
+    emitterState.push_back(state);
+    color.push_back(actorColor);
+    return posX.size() - 1;
+}
+
+void ActorStore::Clear()
+{
+    posX.clear();
+    posY.clear();
+    velX.clear();
+    velY.clear();
+    radius.clear();
+    listenerDistance.clear();
+    inFocus.clear();
+    emitterState.clear();
+    color.clear();
+}
+
+void ActorStore::Reserve(std::size_t count)
+{
+    posX.reserve(count);
+    posY.reserve(count);
+    velX.reserve(count);
+    velY.reserve(count);
+    radius.reserve(count);
+    listenerDistance.reserve(count);
+    inFocus.reserve(count);
+    emitterState.reserve(count);
+    color.reserve(count);
+}
+
+void ActorStore::SetVelocity(std::size_t index, sf::Vector2f velocity)
+{
+    velX[index] = velocity.x;
+    velY[index] = velocity.y;
+}
+
+void ActorStore::Integrate(float deltaTime, sf::Vector2f boundsMin, sf::Vector2f boundsMax)
+{
+    const std::size_t count = Size();
+    float* __restrict px = posX.data();
+    float* __restrict py = posY.data();
+    float* __restrict vx = velX.data();
+    float* __restrict vy = velY.data();
+
+    // Move, then bounce off the bounds with selects instead of branches
+    for (std::size_t i = 0; i < count; ++i)
+    {
+        float x = px[i] + vx[i] * deltaTime;
+        float y = py[i] + vy[i] * deltaTime;
+        bool outX = x < boundsMin.x || x > boundsMax.x;
+        bool outY = y < boundsMin.y || y > boundsMax.y;
+        vx[i] = outX ? -vx[i] : vx[i];
+        vy[i] = outY ? -vy[i] : vy[i];
+        px[i] = std::min(std::max(x, boundsMin.x), boundsMax.x);
+        py[i] = std::min(std::max(y, boundsMin.y), boundsMax.y);
+    }
+}
+
+void ActorStore::UpdateListenerDistance(sf::Vector2f listener)
+{
+    const std::size_t count = Size();
+    const float* __restrict px = posX.data();
+    const float* __restrict py = posY.data();
+    float* __restrict distance = listenerDistance.data();
+
+    for (std::size_t i = 0; i < count; ++i)
+    {
+        float dx = px[i] - listener.x;
+        float dy = py[i] - listener.y;
+        distance[i] = std::sqrt(dx * dx + dy * dy);
+    }
+}
+
+void ActorStore::UpdateFocus(sf::Vector2f listener, float focusRadian, float sectorWidth, float radius)
+{
+    const std::size_t count = Size();
+    const float* __restrict px = posX.data();
+    const float* __restrict py = posY.data();
+    const float* __restrict distance = listenerDistance.data();
+    std::uint8_t* __restrict focus = inFocus.data();
+
+    // Inside the sector when the angle to the focus direction is under half the width,
+    // tested as dot(offset, focus) >= cos(half width) * distance to avoid atan2 per actor
+    float focusX, focusY, sinHalfWidth, cosHalfWidth;
+    fasttrig::SinCos(focusRadian, focusY, focusX);
+    fasttrig::SinCos(sectorWidth * 0.5f, sinHalfWidth, cosHalfWidth);
+
+    for (std::size_t i = 0; i < count; ++i)
+    {
+        float dx = px[i] - listener.x;
+        float dy = py[i] - listener.y;
+        float dot = dx * focusX + dy * focusY;
+        focus[i] = (distance[i] <= radius) & (dot >= cosHalfWidth * distance[i]);
+    }
+}
+
+void ActorStore::BuildVertices(sf::VertexArray& vertices, sf::Color focusColor) const
+{
+    std::vector<sf::Color> colors(Size());
+    for (std::size_t i = 0; i < Size(); ++i)
+    {
+        colors[i] = inFocus[i] ? focusColor : color[i];
+    }
+    BuildActorVertices(vertices, posX.data(), posY.data(), posX.data(), posY.data(), radius.data(), colors.data(), Size(), 1.f);
+}
+
+void BuildActorVertices(sf::VertexArray& vertices, const float* prevX, const float* prevY, const float* posX, const float* posY,
+                        const float* radius, const sf::Color* colors, std::size_t count, float alpha)
+{
+    vertices.setPrimitiveType(sf::PrimitiveType::Triangles);
+    vertices.resize(count * verticesPerActor);
+    if (count == 0)
+        return;
+
+    sf::Vertex* out = &vertices[0];
+    for (std::size_t i = 0; i < count; ++i)
+    {
+        float x = prevX[i] + (posX[i] - prevX[i]) * alpha;
+        float y = prevY[i] + (posY[i] - prevY[i]) * alpha;
+        for (int t = 0; t < hexagonTriangles; ++t)
+        {
+            const int corners[3] = { 0, t + 1, t + 2 };
+            for (int corner : corners)
+            {
+                out->position.x = x + hexagonX[corner] * radius[i];
+                out->position.y = y + hexagonY[corner] * radius[i];
+                out->color = colors[i];
+                ++out;
+            }
+        }
+    }
+}
@@ -0,0 +1,50 @@
+//---------------------Structure of arrays store for audio actors---------------------------
+#pragma once
+
+#include <SFML/Graphics/Color.hpp>
+#include <SFML/Graphics/VertexArray.hpp>
+#include <SFML/System/Vector2.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+enum ActorEmitterState : std::uint8_t
+{
+    ActorSilent = 0,
+    ActorEmitting = 1
+};
+
+// Fills a triangle list with one hexagon per actor, positions blended from prev to current by alpha
+void BuildActorVertices(sf::VertexArray& vertices, const float* prevX, const float* prevY, const float* posX, const float* posY,
+                        const float* radius, const sf::Color* colors, std::size_t count, float alpha);
+
+// Every field lives in its own array so the per-frame passes run as flat, vectorizable loops
+class ActorStore
+{
+public:
+    std::size_t Add(sf::Vector2f position, sf::Vector2f velocity, float radius, sf::Color color, ActorEmitterState emitterState);
+    void Clear();
+    void Reserve(std::size_t count);
+
+    std::size_t Size() const { return posX.size(); }
+    sf::Vector2f GetPosition(std::size_t index) const { return { posX[index], posY[index] }; }
+    void SetVelocity(std::size_t index, sf::Vector2f velocity);
+
+    // Batched passes, run once per frame in this order
+    void Integrate(float deltaTime, sf::Vector2f boundsMin, sf::Vector2f boundsMax);
+    void UpdateListenerDistance(sf::Vector2f listener);
+    void UpdateFocus(sf::Vector2f listener, float focusRadian, float sectorWidth, float radius);
+
+    // Fills a triangle list with one hexagon per actor, single draw call
+    void BuildVertices(sf::VertexArray& vertices, sf::Color focusColor) const;
+
+    std::vector<float> posX;
+    std::vector<float> posY;
+    std::vector<float> velX;
+    std::vector<float> velY;
+    std::vector<float> radius;
+    std::vector<float> listenerDistance;
+    std::vector<std::uint8_t> inFocus;
+    std::vector<std::uint8_t> emitterState;
+    std::vector<sf::Color> color;
+};
@@ -0,0 +1,264 @@
+//---------------------Packed, memory mapped asset bundle---------------------------
+#include "assetbundle.h"
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+
+namespace
+{
+    const char bundleMagic[4] = { 'A', 'B', 'N', 'D' };
+    const std::uint32_t bundleVersion = 2;
+
+    // Payloads start on cache line boundaries so samples can be read with aligned SIMD loads
+    const std::uint64_t payloadAlignment = 64;
+
+    enum AssetType : std::uint32_t
+    {
+        AssetTypeAudio = 1,
+        AssetTypeBlob = 2
+    };
+
+    struct BundleHeader
+    {
+        char magic[4];
+        std::uint32_t version;
+        std::int32_t samplingRate;
+        std::uint32_t entryCount;
+        std::uint64_t fileSize;
+    };
+
+    // Index follows the header, one entry per asset. The source is the loose file it was baked
+    // from, relative to the working directory the baker ran in.
+    struct BundleEntry
+    {
+        char name[48];
+        std::uint32_t type;
+        std::uint32_t reserved;
+        std::uint64_t offset;
+        std::uint64_t size;
+        char source[112];
+        std::uint64_t sourceSize;
+        std::int64_t sourceModified;
+    };
+
+    bool StatSource(const std::string& path, std::uint64_t& size, std::int64_t& modified)
+    {
+        std::error_code error;
+        size = std::filesystem::file_size(path, error);
+        if (error)
+            return false;
+        modified = std::filesystem::last_write_time(path, error).time_since_epoch().count();
+        return !error;
+    }
+
+    std::uint64_t AlignUp(std::uint64_t value)
+    {
+        return (value + payloadAlignment - 1) / payloadAlignment * payloadAlignment;
+    }
+}
+
+AssetBundle::AssetBundle() :
+    entryCount(0),
+    samplingRate(0)
+{
+}
+
+bool AssetBundle::Open(const std::string& path)
+{
+    Close();
+    if (!file.Open(path))
+        return false;
+
+    BundleHeader header;
+    if (file.Size() < sizeof(header))
+    {
+        std::cerr << "Asset bundle is truncated: " << path << std::endl;
+        Close();
+        return false;
+    }
+    std::memcpy(&header, file.Data(), sizeof(header));
+
+    bool valid = std::memcmp(header.magic, bundleMagic, sizeof(bundleMagic)) == 0 &&
+                 header.version == bundleVersion &&
+                 header.fileSize == file.Size() &&
+                 sizeof(header) + std::uint64_t(header.entryCount) * sizeof(BundleEntry) <= file.Size();
+    if (!valid)
+    {
+        std::cerr << "Asset bundle is invalid or out of date: " << path << std::endl;
+        Close();
+        return false;
+    }
+
+    // Every payload has to lie inside the file before anything points into it
+    const BundleEntry* entries = reinterpret_cast<const BundleEntry*>(file.Data() + sizeof(header));
+    for (std::uint32_t i = 0; i < header.entryCount; ++i)
+    {
+        if (entries[i].offset > file.Size() || entries[i].size > file.Size() - entries[i].offset)
+        {
+            std::cerr << "Asset bundle entry out of range: " << path << std::endl;
+            Close();
+            return false;
+        }
+
+        // A missing source is fine, bundles ship without the loose files
+        const char* sourceEnd = std::find(entries[i].source, entries[i].source + sizeof(entries[i].source), '\0');
+        std::string source(entries[i].source, sourceEnd);
+        std::uint64_t sourceSize;
+        std::int64_t sourceModified;
+        if (!source.empty() && StatSource(source, sourceSize, sourceModified) &&
+            (sourceSize != entries[i].sourceSize || sourceModified != entries[i].sourceModified))
+        {
+            std::cerr << "Asset bundle is stale, " << source << " changed since it was baked: " << path << std::endl;
+            Close();
+            return false;
+        }
+    }
+
+    entryCount = header.entryCount;
+    samplingRate = header.samplingRate;
+    return true;
+}
+
+void AssetBundle::Close()
+{
+    file.Close();
+    entryCount = 0;
+    samplingRate = 0;
+}
+
+bool AssetBundle::FindAudio(const std::string& name, AssetAudio& audio) const
+{
+    std::size_t size = 0;
+    const std::uint8_t* payload = FindEntry(name, AssetTypeAudio, size);
+    if (!payload)
+        return false;
+
+    audio.samples = reinterpret_cast<const float*>(payload);
+    audio.sampleCount = size / sizeof(float);
+    audio.samplingRate = samplingRate;
+    return true;
+}
+
+bool AssetBundle::FindBlob(const std::string& name, AssetBlob& blob) const
+{
+    std::size_t size = 0;
+    const std::uint8_t* payload = FindEntry(name, AssetTypeBlob, size);
+    if (!payload)
+        return false;
+
+    blob.data = payload;
+    blob.size = size;
+    return true;
+}
+
+const std::uint8_t* AssetBundle::FindEntry(const std::string& name, std::uint32_t type, std::size_t& size) const
+{
+    if (!IsOpen())
+        return nullptr;
+
+    // A handful of assets, a linear scan of the index is plenty
+    const BundleEntry* entries = reinterpret_cast<const BundleEntry*>(file.Data() + sizeof(BundleHeader));
+    for (std::uint32_t i = 0; i < entryCount; ++i)
+    {
+        if (entries[i].type == type && std::strncmp(entries[i].name, name.c_str(), sizeof(entries[i].name)) == 0)
+        {
+            size = static_cast<std::size_t>(entries[i].size);
+            return file.Data() + entries[i].offset;
+        }
+    }
+    return nullptr;
+}
+
+AssetBundleWriter::AssetBundleWriter(int samplingRate) :
+    samplingRate(samplingRate)
+{
+}
+
+void AssetBundleWriter::AddAudio(const std::string& name, std::vector<float> samples, const std::string& sourcePath)
+{
+    std::vector<std::uint8_t> bytes(samples.size() * sizeof(float));
+    std::memcpy(bytes.data(), samples.data(), bytes.size());
+    entries.push_back({ name, AssetTypeAudio, std::move(bytes), sourcePath });
+}
+
+void AssetBundleWriter::AddBlob(const std::string& name, std::vector<std::uint8_t> bytes, const std::string& sourcePath)
+{
+    entries.push_back({ name, AssetTypeBlob, std::move(bytes), sourcePath });
+}
+
+bool AssetBundleWriter::Write(const std::string& path) const
+{
+    std::vector<BundleEntry> index(entries.size());
+    std::uint64_t offset = AlignUp(sizeof(BundleHeader) + index.size() * sizeof(BundleEntry));
+    for (std::size_t i = 0; i < entries.size(); ++i)
+    {
+        if (entries[i].name.size() >= sizeof(index[i].name))
+        {
+            std::cerr << "Asset name too long for bundle index: " << entries[i].name << std::endl;
+            return false;
+        }
+        if (entries[i].sourcePath.size() >= sizeof(index[i].source))
+        {
+            std::cerr << "Asset source path too long for bundle index: " << entries[i].sourcePath << std::endl;
+            return false;
+        }
+        if (!StatSource(entries[i].sourcePath, index[i].sourceSize, index[i].sourceModified))
+        {
+            std::cerr << "Failed to stat asset source: " << entries[i].sourcePath << std::endl;
+            return false;
+        }
+        std::memcpy(index[i].name, entries[i].name.c_str(), entries[i].name.size() + 1);
+        std::memcpy(index[i].source, entries[i].sourcePath.c_str(), entries[i].sourcePath.size() + 1);
+        index[i].type = entries[i].type;
+        index[i].offset = offset;
+        index[i].size = entries[i].bytes.size();
+        offset = AlignUp(offset + entries[i].bytes.size());
+    }
+
+    BundleHeader header{};
+    std::memcpy(header.magic, bundleMagic, sizeof(bundleMagic));
+    header.version = bundleVersion;
+    header.samplingRate = samplingRate;
+    header.entryCount = static_cast<std::uint32_t>(index.size());
+    header.fileSize = offset;
+
+    // Written under a temporary name and renamed, a running game never maps a half written bundle
+    std::string tempPath = path + ".tmp";
+    std::ofstream out(tempPath, std::ios::binary | std::ios::trunc);
+    if (!out)
+    {
+        std::cerr << "Failed to write asset bundle: " << path << std::endl;
+        return false;
+    }
+
+    out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    out.write(reinterpret_cast<const char*>(index.data()), static_cast<std::streamsize>(index.size() * sizeof(BundleEntry)));
+    for (std::size_t i = 0; i < entries.size(); ++i)
+    {
+        out.seekp(static_cast<std::streamoff>(index[i].offset));
+        out.write(reinterpret_cast<const char*>(entries[i].bytes.data()), static_cast<std::streamsize>(entries[i].bytes.size()));
+    }
+
+    // Pad the tail so fileSize matches what the reader sees
+    out.seekp(0, std::ios::end);
+    std::uint64_t written = static_cast<std::uint64_t>(out.tellp());
+    std::vector<char> padding(static_cast<std::size_t>(offset - written), '\0');
+    out.write(padding.data(), static_cast<std::streamsize>(padding.size()));
+    out.close();
+    if (!out)
+    {
+        std::cerr << "Failed to write asset bundle: " << path << std::endl;
+        return false;
+    }
+
+    std::error_code error;
+    std::filesystem::rename(tempPath, path, error);
+    if (error)
+    {
+        std::cerr << "Failed to write asset bundle: " << path << std::endl;
+        return false;
+    }
+    return true;
+}
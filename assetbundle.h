@@ -0,0 +1,74 @@
+//---------------------Packed, memory mapped asset bundle---------------------------
+#pragma once
+
+#include "mappedfile.h"
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Mono float PCM at the bundle's engine rate, used in place from the mapping
+struct AssetAudio
+{
+    const float* samples = nullptr;
+    std::size_t sampleCount = 0;
+    int samplingRate = 0;
+};
+
+// Raw bytes, e.g. a font handed to sf::Font::loadFromMemory
+struct AssetBlob
+{
+    const std::uint8_t* data = nullptr;
+    std::size_t size = 0;
+};
+
+// Read side, the bundle stays mapped for as long as this object lives
+class AssetBundle
+{
+public:
+    AssetBundle();
+
+    // Fails when the bundle is invalid, or when a source it was baked from still exists and its
+    // size or modification time no longer matches, so the caller falls back to the loose files
+    bool Open(const std::string& path);
+    void Close();
+
+    bool IsOpen() const { return file.IsOpen(); }
+    int GetSamplingRate() const { return samplingRate; }
+
+    bool FindAudio(const std::string& name, AssetAudio& audio) const;
+    bool FindBlob(const std::string& name, AssetBlob& blob) const;
+
+private:
+    const std::uint8_t* FindEntry(const std::string& name, std::uint32_t type, std::size_t& size) const;
+
+    MappedFile file;
+    std::uint32_t entryCount;
+    int samplingRate;
+};
+
+// Write side, used by the asset baker
+class AssetBundleWriter
+{
+public:
+    explicit AssetBundleWriter(int samplingRate);
+
+    // samples must already be mono at the writer's rate. sourcePath is the loose file the asset
+    // came from, its size and modification time are recorded for Open's staleness check.
+    void AddAudio(const std::string& name, std::vector<float> samples, const std::string& sourcePath);
+    void AddBlob(const std::string& name, std::vector<std::uint8_t> bytes, const std::string& sourcePath);
+
+    bool Write(const std::string& path) const;
+
+private:
+    struct Entry
+    {
+        std::string name;
+        std::uint32_t type;
+        std::vector<std::uint8_t> bytes;
+        std::string sourcePath;
+    };
+
+    int samplingRate;
+    std::vector<Entry> entries;
+};
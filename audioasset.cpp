@@ -0,0 +1,46 @@
+//---------------------Loose audio asset loading---------------------------
+#include "audioasset.h"
+#include "resampler.h"
+#include "sampleconvert.h"
+#include <iostream>
+
+bool LoadMonoSamples(const std::string& path, int samplingRate, std::vector<float>& samples)
+{
+    sf::InputSoundFile file;
+    if (!file.openFromFile(path))
+    {
+        std::cerr << "Failed to load audio file: " << path << std::endl;
+        return false;
+    }
+
+    unsigned int channels = file.getChannelCount();
+    std::vector<sf::Int16> interleaved(static_cast<std::size_t>(file.getSampleCount()));
+    std::size_t read = static_cast<std::size_t>(file.read(interleaved.data(), interleaved.size()));
+
+    // Binaural processing wants a mono source, average the channels rather than rejecting the file
+    std::size_t frames = read / channels;
+    samples.assign(frames, 0.f);
+    float scale = 1.f / (32767.f * channels);
+    for (std::size_t frame = 0; frame < frames; ++frame)
+    {
+        float sum = 0.f;
+        for (unsigned int channel = 0; channel < channels; ++channel)
+        {
+            sum += interleaved[frame * channels + channel];
+        }
+        samples[frame] = sum * scale;
+    }
+
+    if (static_cast<int>(file.getSampleRate()) != samplingRate)
+    {
+        samples = Resample(samples, file.getSampleRate(), samplingRate);
+    }
+    return true;
+}
+
+bool FillSoundBuffer(const float* samples, std::size_t sampleCount, int samplingRate, sf::SoundBuffer& buffer)
+{
+    std::vector<sf::Int16> converted(sampleCount);
+    FloatToInt16(samples, converted.data(), sampleCount);
+    return buffer.loadFromSamples(converted.data(), converted.size(), 1, samplingRate);
+}
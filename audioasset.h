@@ -0,0 +1,13 @@
+//---------------------Loose audio asset loading---------------------------
+#pragma once
+
+#include <SFML/Audio.hpp>
+#include <cstddef>
+#include <string>
+#include <vector>
+
+// Decodes any file SFML reads into mono float PCM at samplingRate (channels are averaged)
+bool LoadMonoSamples(const std::string& path, int samplingRate, std::vector<float>& samples);
+
+// Int16 copy for plain sf::Sound playback of an engine-rate clip
+bool FillSoundBuffer(const float* samples, std::size_t sampleCount, int samplingRate, sf::SoundBuffer& buffer);
@@ -0,0 +1,18 @@
+//---------------------Runtime audio settings shared by the whole chain---------------------------
+#pragma once
+
+#include <cstddef>
+#include <string>
+
+// Set once at startup (--rate, --block) and handed to Steam Audio, the mixer and asset loading
+struct AudioConfig
+{
+    int samplingRate = 44100;
+    int frameSize = 512;
+
+    // Highest instruction set Steam Audio may use (sse2, sse4, avx, avx2, avx512), it never goes past what the CPU has
+    std::string simdLevel = "avx512";
+
+    // Cap on Steam Audio's internal memory in bytes, 0 means unlimited
+    std::size_t memoryCapBytes = 0;
+};
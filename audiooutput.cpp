@@ -0,0 +1,375 @@
+//---------------------Float output backends: ALSA, null and file sinks---------------------------
+#include "audiooutput.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <fstream>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+#if defined(HAVE_ALSA)
+#include <alsa/asoundlib.h>
+#endif
+
+namespace
+{
+    using Clock = std::chrono::steady_clock;
+
+    void WriteLE(std::ofstream& out, std::uint32_t value, int bytes)
+    {
+        for (int i = 0; i < bytes; ++i)
+        {
+            out.put(static_cast<char>((value >> (8 * i)) & 0xff));
+        }
+    }
+
+    // Paced by the clock instead of a device, optionally keeps what it rendered as a 32-bit float WAV
+    class NullOutput : public AudioOutput
+    {
+    public:
+        explicit NullOutput(const std::string& path) : path(path) {}
+        ~NullOutput() override { Stop(); }
+
+        bool Open(const AudioOutputSettings& requested) override
+        {
+            settings = requested;
+            period.assign(std::size_t(settings.periodFrames) * settings.channels, 0.f);
+            if (path.empty())
+                return true;
+
+            file.open(path, std::ios::binary | std::ios::trunc);
+            if (!file)
+            {
+                std::cerr << "Failed to create output file " << path << std::endl;
+                return false;
+            }
+            WriteHeader(0);
+            return true;
+        }
+
+        bool Start(AudioRenderer& renderer) override
+        {
+            if (running.exchange(true))
+                return false;
+            thread = std::thread([this, &renderer]() { Run(renderer); });
+            return true;
+        }
+
+        void Stop() override
+        {
+            if (!running.exchange(false))
+                return;
+            thread.join();
+            if (file.is_open())
+            {
+                file.seekp(0);
+                WriteHeader(dataBytes);
+                file.close();
+            }
+        }
+
+        const char* GetName() const override { return path.empty() ? "null" : "file"; }
+
+    private:
+        void WriteHeader(std::uint32_t bytes)
+        {
+            // WAVE_FORMAT_IEEE_FLOAT
+            std::uint32_t blockAlign = settings.channels * sizeof(float);
+            file.write("RIFF", 4);
+            WriteLE(file, 36 + bytes, 4);
+            file.write("WAVEfmt ", 8);
+            WriteLE(file, 16, 4);
+            WriteLE(file, 3, 2);
+            WriteLE(file, settings.channels, 2);
+            WriteLE(file, settings.samplingRate, 4);
+            WriteLE(file, settings.samplingRate * blockAlign, 4);
+            WriteLE(file, blockAlign, 2);
+            WriteLE(file, 32, 2);
+            file.write("data", 4);
+            WriteLE(file, bytes, 4);
+        }
+
+        void Run(AudioRenderer& renderer)
+        {
+            Clock::duration periodTime = std::chrono::duration_cast<Clock::duration>(
+                std::chrono::duration<double>(double(settings.periodFrames) / settings.samplingRate));
+            Clock::time_point next = Clock::now();
+            while (running.load(std::memory_order_acquire))
+            {
+                renderer.Render(period.data(), settings.periodFrames);
+                // No device queue, the period plays from now until the next one is due
+                written += settings.periodFrames;
+                PublishPosition(written - settings.periodFrames, written);
+                if (file.is_open())
+                {
+                    // Float samples are written as they sit in memory, little endian hosts only
+                    file.write(reinterpret_cast<const char*>(period.data()), period.size() * sizeof(float));
+                    dataBytes += static_cast<std::uint32_t>(period.size() * sizeof(float));
+                }
+
+                next += periodTime;
+                if (Clock::now() > next + periodTime * settings.periodCount)
+                {
+                    // Fell behind by more than the queue, a device would have underrun here
+                    ++underruns;
+                    next = Clock::now();
+                }
+                std::this_thread::sleep_until(next);
+            }
+        }
+
+        std::string path;
+        std::ofstream file;
+        std::uint32_t dataBytes = 0;
+        std::uint64_t written = 0;
+        std::vector<float> period;
+        std::atomic<bool> running {false};
+        std::thread thread;
+    };
+
+#if defined(HAVE_ALSA)
+    // Float32 interleaved straight into the ring ALSA shares with the driver (mmap access), with a
+    // writei fallback for devices that only take copies. "default" goes through PulseAudio or
+    // PipeWire where they run, "hw:0" talks to the card directly for the lowest latency.
+    class AlsaOutput : public AudioOutput
+    {
+    public:
+        explicit AlsaOutput(const std::string& device) : device(device.empty() ? "default" : device) {}
+        ~AlsaOutput() override
+        {
+            Stop();
+            if (pcm)
+                snd_pcm_close(pcm);
+        }
+
+        bool Open(const AudioOutputSettings& requested) override
+        {
+            settings = requested;
+            int err = snd_pcm_open(&pcm, device.c_str(), SND_PCM_STREAM_PLAYBACK, 0);
+            if (err < 0)
+            {
+                std::cerr << "ALSA: failed to open " << device << ": " << snd_strerror(err) << std::endl;
+                pcm = nullptr;
+                return false;
+            }
+
+            snd_pcm_hw_params_t* hw;
+            snd_pcm_hw_params_alloca(&hw);
+            snd_pcm_hw_params_any(pcm, hw);
+            mmapAccess = snd_pcm_hw_params_set_access(pcm, hw, SND_PCM_ACCESS_MMAP_INTERLEAVED) == 0;
+            if (!mmapAccess && snd_pcm_hw_params_set_access(pcm, hw, SND_PCM_ACCESS_RW_INTERLEAVED) < 0)
+                return Fail("no interleaved access");
+            if (snd_pcm_hw_params_set_format(pcm, hw, SND_PCM_FORMAT_FLOAT_LE) < 0)
+                return Fail("float32 is not supported by this device");
+            if (snd_pcm_hw_params_set_channels(pcm, hw, settings.channels) < 0)
+                return Fail("channel count refused");
+
+            unsigned rate = settings.samplingRate;
+            snd_pcm_hw_params_set_rate_resample(pcm, hw, 0);
+            if (snd_pcm_hw_params_set_rate_near(pcm, hw, &rate, nullptr) < 0 || int(rate) != settings.samplingRate)
+                return Fail("sampling rate refused, pick the device's native --rate");
+
+            snd_pcm_uframes_t periodFrames = settings.periodFrames;
+            unsigned periods = settings.periodCount;
+            snd_pcm_hw_params_set_period_size_near(pcm, hw, &periodFrames, nullptr);
+            snd_pcm_hw_params_set_periods_near(pcm, hw, &periods, nullptr);
+            if ((err = snd_pcm_hw_params(pcm, hw)) < 0)
+                return Fail(snd_strerror(err));
+            settings.periodFrames = static_cast<int>(periodFrames);
+            settings.periodCount = static_cast<int>(periods);
+
+            // Start as soon as one period is queued, wake up whenever a whole period is free
+            snd_pcm_sw_params_t* sw;
+            snd_pcm_sw_params_alloca(&sw);
+            snd_pcm_sw_params_current(pcm, sw);
+            snd_pcm_sw_params_set_start_threshold(pcm, sw, periodFrames);
+            snd_pcm_sw_params_set_avail_min(pcm, sw, periodFrames);
+            if ((err = snd_pcm_sw_params(pcm, sw)) < 0)
+                return Fail(snd_strerror(err));
+
+            if (!mmapAccess)
+                scratch.assign(std::size_t(settings.periodFrames) * settings.channels, 0.f);
+            return true;
+        }
+
+        bool Start(AudioRenderer& renderer) override
+        {
+            if (!pcm || running.exchange(true))
+                return false;
+            snd_pcm_prepare(pcm);
+            thread = std::thread([this, &renderer]() { Run(renderer); });
+            return true;
+        }
+
+        void Stop() override
+        {
+            if (!running.exchange(false))
+                return;
+            thread.join();
+            snd_pcm_drop(pcm);
+        }
+
+        const char* GetName() const override { return mmapAccess ? "alsa (mmap)" : "alsa"; }
+
+    private:
+        bool Fail(const char* reason)
+        {
+            std::cerr << "ALSA: " << device << ": " << reason << std::endl;
+            snd_pcm_close(pcm);
+            pcm = nullptr;
+            return false;
+        }
+
+        // Underrun or suspend, counted and restarted
+        void Recover(int err)
+        {
+            if (err == -EPIPE)
+                ++underruns;
+            if (snd_pcm_recover(pcm, err, 1) < 0)
+                snd_pcm_prepare(pcm);
+        }
+
+        void Run(AudioRenderer& renderer)
+        {
+            const snd_pcm_uframes_t period = settings.periodFrames;
+            while (running.load(std::memory_order_acquire))
+            {
+                snd_pcm_sframes_t avail = snd_pcm_avail_update(pcm);
+                if (avail < 0)
+                {
+                    Recover(static_cast<int>(avail));
+                    continue;
+                }
+                if (snd_pcm_uframes_t(avail) < period)
+                {
+                    snd_pcm_wait(pcm, 100);
+                    continue;
+                }
+
+                if (!mmapAccess)
+                {
+                    renderer.Render(scratch.data(), settings.periodFrames);
+                    snd_pcm_sframes_t frames = snd_pcm_writei(pcm, scratch.data(), period);
+                    if (frames < 0)
+                        Recover(static_cast<int>(frames));
+                    else
+                        written += frames;
+                    Publish();
+                    continue;
+                }
+
+                // The ring may wrap inside a period, mmap_begin then hands out the part up to the end
+                snd_pcm_uframes_t remaining = period;
+                while (remaining > 0)
+                {
+                    const snd_pcm_channel_area_t* areas;
+                    snd_pcm_uframes_t offset;
+                    snd_pcm_uframes_t frames = remaining;
+                    int err = snd_pcm_mmap_begin(pcm, &areas, &offset, &frames);
+                    if (err < 0)
+                    {
+                        Recover(err);
+                        break;
+                    }
+
+                    float* destination = reinterpret_cast<float*>(static_cast<char*>(areas[0].addr) + areas[0].first / 8 + offset * areas[0].step / 8);
+                    renderer.Render(destination, static_cast<int>(frames));
+
+                    snd_pcm_sframes_t committed = snd_pcm_mmap_commit(pcm, offset, frames);
+                    if (committed < 0 || snd_pcm_uframes_t(committed) != frames)
+                    {
+                        Recover(committed < 0 ? static_cast<int>(committed) : -EPIPE);
+                        break;
+                    }
+                    remaining -= frames;
+                    written += frames;
+                }
+                Publish();
+            }
+        }
+
+        // Whatever is still queued in the driver has not been heard yet
+        void Publish()
+        {
+            snd_pcm_sframes_t delay = 0;
+            if (snd_pcm_delay(pcm, &delay) < 0)
+                delay = 0;
+            delay = std::max<snd_pcm_sframes_t>(0, std::min<snd_pcm_sframes_t>(delay, snd_pcm_sframes_t(written)));
+            PublishPosition(written - std::uint64_t(delay), written);
+        }
+
+        std::string device;
+        snd_pcm_t* pcm = nullptr;
+        bool mmapAccess = false;
+        std::uint64_t written = 0;
+        std::vector<float> scratch;
+        std::atomic<bool> running {false};
+        std::thread thread;
+    };
+#endif
+}
+
+std::uint64_t AudioOutput::GetPlayedFrames() const
+{
+    std::uint64_t played;
+    std::uint64_t written;
+    std::int64_t time;
+    unsigned sequence;
+    do
+    {
+        sequence = positionSequence.load(std::memory_order_acquire);
+        played = positionPlayed.load(std::memory_order_relaxed);
+        written = positionWritten.load(std::memory_order_relaxed);
+        time = positionTime.load(std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_acquire);
+    } while ((sequence & 1) || sequence != positionSequence.load(std::memory_order_relaxed));
+
+    if (written == 0)
+        return 0;
+    double since = std::chrono::duration<double>(Clock::now().time_since_epoch() - Clock::duration(time)).count();
+    std::uint64_t advanced = static_cast<std::uint64_t>(std::max(0.0, since) * settings.samplingRate);
+    return std::min(written, played + advanced);
+}
+
+void AudioOutput::PublishPosition(std::uint64_t played, std::uint64_t written)
+{
+    unsigned sequence = positionSequence.load(std::memory_order_relaxed);
+    positionSequence.store(sequence + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    positionPlayed.store(played, std::memory_order_relaxed);
+    positionWritten.store(written, std::memory_order_relaxed);
+    positionTime.store(Clock::now().time_since_epoch().count(), std::memory_order_relaxed);
+    positionSequence.store(sequence + 2, std::memory_order_release);
+}
+
+std::unique_ptr<AudioOutput> CreateAudioOutput(const std::string& spec)
+{
+    std::string name = spec.substr(0, spec.find(':'));
+    std::string argument = spec.find(':') == std::string::npos ? "" : spec.substr(spec.find(':') + 1);
+
+    if (name == "null")
+        return std::unique_ptr<AudioOutput>(new NullOutput(""));
+    if (name == "file")
+    {
+        if (argument.empty())
+        {
+            std::cerr << "The file output needs a path, file:<path.wav>" << std::endl;
+            return nullptr;
+        }
+        return std::unique_ptr<AudioOutput>(new NullOutput(argument));
+    }
+    if (name == "alsa")
+    {
+#if defined(HAVE_ALSA)
+        return std::unique_ptr<AudioOutput>(new AlsaOutput(argument));
+#else
+        std::cerr << "Built without ALSA, install the ALSA headers and rebuild" << std::endl;
+        return nullptr;
+#endif
+    }
+
+    std::cerr << "Unknown audio output " << spec << std::endl;
+    return nullptr;
+}
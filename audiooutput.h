@@ -0,0 +1,67 @@
+//---------------------Float output backends: ALSA, null and file sinks---------------------------
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <string>
+
+// Fills interleaved float frames, called on the output's thread with the device's own buffer
+// when the backend can hand it out, so nothing is copied between the mix and the device
+class AudioRenderer
+{
+public:
+    virtual ~AudioRenderer() = default;
+    virtual void Render(float* interleaved, int frameCount) = 0;
+};
+
+struct AudioOutputSettings
+{
+    int samplingRate = 44100;
+    int channels = 2;
+    int periodFrames = 512;
+    int periodCount = 2;
+};
+
+// Owns a thread that pulls periods from a renderer. Open may adjust the settings to what the
+// device accepts, GetSettings returns the result.
+class AudioOutput
+{
+public:
+    virtual ~AudioOutput() = default;
+
+    virtual bool Open(const AudioOutputSettings& settings) = 0;
+    virtual bool Start(AudioRenderer& renderer) = 0;
+    virtual void Stop() = 0;
+
+    virtual const char* GetName() const = 0;
+    const AudioOutputSettings& GetSettings() const { return settings; }
+
+    // Time from Render writing a frame to the device playing it, the queued periods
+    double GetLatencySeconds() const { return double(settings.periodFrames) * settings.periodCount / settings.samplingRate; }
+
+    // Device underruns recovered from, the renderer was late
+    unsigned GetUnderruns() const { return underruns; }
+
+    // Any thread, frames the device has played so far. Extrapolated at the sampling rate from the
+    // position the output thread last read from the device, and never past what was handed over.
+    std::uint64_t GetPlayedFrames() const;
+
+protected:
+    // Output thread, played is the device's position now and written what it has been given
+    void PublishPosition(std::uint64_t played, std::uint64_t written);
+
+    AudioOutputSettings settings;
+    unsigned underruns = 0;
+
+private:
+    // Odd while a position is being written, readers retry
+    std::atomic<unsigned> positionSequence {0};
+    std::atomic<std::uint64_t> positionPlayed {0};
+    std::atomic<std::uint64_t> positionWritten {0};
+    std::atomic<std::int64_t> positionTime {0};
+};
+
+// "alsa" or "alsa:<device>", "null", or "file:<path.wav>" for a float WAV written in real time.
+// Prints to std::cerr and returns nullptr for an unknown or unavailable backend.
+std::unique_ptr<AudioOutput> CreateAudioOutput(const std::string& spec);
@@ -0,0 +1,25 @@
+//---------------------Random actor population shared by the actor benches---------------------------
+#pragma once
+
+#include "../actorstore.h"
+#include <random>
+
+namespace bench
+{
+    // Same seed every call, actors scattered over worldSize wandering up to wanderSpeed per axis
+    inline ActorStore MakeActors(int actorCount, sf::Vector2f worldSize, float wanderSpeed)
+    {
+        std::mt19937 rng(42);
+        std::uniform_real_distribution<float> randX(0.f, worldSize.x);
+        std::uniform_real_distribution<float> randY(0.f, worldSize.y);
+        std::uniform_real_distribution<float> randVelocity(-wanderSpeed, wanderSpeed);
+
+        ActorStore actors;
+        actors.Reserve(actorCount);
+        for (int i = 0; i < actorCount; ++i)
+        {
+            actors.Add({ randX(rng), randY(rng) }, { randVelocity(rng), randVelocity(rng) }, 4.f, sf::Color(100, 100, 255), ActorEmitting);
+        }
+        return actors;
+    }
+}
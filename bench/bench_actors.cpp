@@ -0,0 +1,56 @@
+//---------------------Actor store per-frame passes (1k, 10k, 100k actors)---------------------------
+#include "benchmark.h"
+#include "actorfixture.h"
+#include <string>
+
+namespace
+{
+    const sf::Vector2f boundsMin(0.f, 0.f);
+    const sf::Vector2f boundsMax(1920.f, 1080.f);
+    const sf::Vector2f listener(960.f, 540.f);
+
+    void RegisterActorCases()
+    {
+        const int actorCounts[] = { 1000, 10000, 100000 };
+        for (int actorCount : actorCounts)
+        {
+            std::string suffix = "/" + std::to_string(actorCount / 1000) + "k";
+
+            bench::Register("actors/integrate" + suffix, [actorCount](bench::State& state)
+            {
+                ActorStore actors = bench::MakeActors(actorCount, boundsMax - boundsMin, 60.f);
+                state.SetItems(actorCount);
+                state.Measure([&]() { actors.Integrate(1.f / 60.f, boundsMin, boundsMax); });
+            });
+
+            bench::Register("actors/listener_distance" + suffix, [actorCount](bench::State& state)
+            {
+                ActorStore actors = bench::MakeActors(actorCount, boundsMax - boundsMin, 60.f);
+                state.SetItems(actorCount);
+                state.Measure([&]() { actors.UpdateListenerDistance(listener); });
+            });
+
+            bench::Register("actors/focus" + suffix, [actorCount](bench::State& state)
+            {
+                ActorStore actors = bench::MakeActors(actorCount, boundsMax - boundsMin, 60.f);
+                float focusRadian = 0.f;
+                state.SetItems(actorCount);
+                state.Measure([&]()
+                {
+                    focusRadian += 0.05f;
+                    actors.UpdateFocus(listener, focusRadian, 1.f, 400.f);
+                });
+            });
+
+            bench::Register("actors/vertices" + suffix, [actorCount](bench::State& state)
+            {
+                ActorStore actors = bench::MakeActors(actorCount, boundsMax - boundsMin, 60.f);
+                sf::VertexArray vertices;
+                state.SetItems(actorCount);
+                state.Measure([&]() { actors.BuildVertices(vertices, sf::Color::White); });
+            });
+        }
+    }
+}
+
+BENCH_REGISTER(RegisterActorCases);
@@ -0,0 +1,122 @@
+//---------------------Startup asset load, loose files against the mapped bundle---------------------------
+#include "benchmark.h"
+#include "../assetbundle.h"
+#include "../audioasset.h"
+#include <SFML/Graphics.hpp>
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <vector>
+#ifndef _WIN32
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+namespace
+{
+    const char* wavPath = "assets/audiofiles/radarSFX.wav";
+    const char* fontPath = "assets/fonts/ARIAL.TTF";
+    const char* bundlePath = "bench/bench_assets.bundle";
+    const int samplingRate = 44100;
+
+    // Asks the OS to drop the file from the page cache so the next read hits the disk.
+    // Best effort: the kernel may keep dirty or mapped pages, Windows has no per-file equivalent.
+    void EvictFromPageCache(const char* path)
+    {
+#ifndef _WIN32
+        int fd = open(path, O_RDONLY);
+        if (fd < 0)
+            return;
+        fdatasync(fd);
+        posix_fadvise(fd, 0, 0, POSIX_FADV_DONTNEED);
+        close(fd);
+#else
+        (void)path;
+#endif
+    }
+
+    double Milliseconds(bench::Clock::time_point start)
+    {
+        return std::chrono::duration<double, std::milli>(bench::Clock::now() - start).count();
+    }
+
+    // What main() does on the loose path
+    void LoadLoose()
+    {
+        std::vector<float> samples;
+        LoadMonoSamples(wavPath, samplingRate, samples);
+        sf::Font font;
+        font.loadFromFile(fontPath);
+    }
+
+    // What main() does on the bundle path, touching every sample so the pages are really read
+    void LoadBundle()
+    {
+        AssetBundle bundle;
+        AssetAudio radar;
+        AssetBlob fontBlob;
+        bundle.Open(bundlePath);
+        bundle.FindAudio("radar", radar);
+        bundle.FindBlob("font", fontBlob);
+        float checksum = 0.f;
+        for (std::size_t i = 0; i < radar.sampleCount; ++i)
+        {
+            checksum += radar.samples[i];
+        }
+        bench::KeepAlive(checksum);
+        sf::Font font;
+        font.loadFromMemory(fontBlob.data, fontBlob.size);
+    }
+
+    // Bakes a bundle the same way tools/assetbaker does
+    bool BakeBundle()
+    {
+        std::vector<float> samples;
+        std::ifstream fontIn(fontPath, std::ios::binary);
+        if (!fontIn || !LoadMonoSamples(wavPath, samplingRate, samples))
+            return false;
+
+        AssetBundleWriter writer(samplingRate);
+        writer.AddAudio("radar", std::move(samples), wavPath);
+        writer.AddBlob("font", std::vector<std::uint8_t>(std::istreambuf_iterator<char>(fontIn), std::istreambuf_iterator<char>()), fontPath);
+        return writer.Write(bundlePath);
+    }
+
+    void RegisterAssetCases()
+    {
+        // Cold is a single evicted load, reported as a counter, ns/op is the warm load
+        bench::Register("assets/startup_loose", [](bench::State& state)
+        {
+            std::ifstream probe(wavPath);
+            if (!probe)
+            {
+                state.Skip("run from the repository root with assets/ present");
+                return;
+            }
+            EvictFromPageCache(wavPath);
+            EvictFromPageCache(fontPath);
+            bench::Clock::time_point start = bench::Clock::now();
+            LoadLoose();
+            state.SetCounter("cold_ms", Milliseconds(start));
+            state.Measure(LoadLoose);
+        });
+
+        bench::Register("assets/startup_bundle", [](bench::State& state)
+        {
+            if (!BakeBundle())
+            {
+                state.Skip("run from the repository root with assets/ present");
+                return;
+            }
+            EvictFromPageCache(bundlePath);
+            bench::Clock::time_point start = bench::Clock::now();
+            LoadBundle();
+            state.SetCounter("cold_ms", Milliseconds(start));
+            state.Measure(LoadBundle);
+            std::remove(bundlePath);
+        });
+    }
+}
+
+BENCH_REGISTER(RegisterAssetCases);
@@ -0,0 +1,63 @@
+//---------------------PCM conversion and focus shape geometry---------------------------
+#include "benchmark.h"
+#include "../focusshape.h"
+#include "../sampleconvert.h"
+#include <vector>
+
+namespace
+{
+    // One second of stereo at 48 kHz
+    const std::size_t sampleCount = 96000;
+
+    void RegisterConvertCases()
+    {
+        bench::Register("convert/int16_to_float", [](bench::State& state)
+        {
+            std::vector<sf::Int16> input(sampleCount);
+            std::vector<float> output(sampleCount);
+            for (std::size_t i = 0; i < sampleCount; ++i)
+            {
+                input[i] = static_cast<sf::Int16>((i * 37) & 0x7fff);
+            }
+            state.SetItems(double(sampleCount));
+            state.Measure([&]()
+            {
+                Int16ToFloat(input.data(), output.data(), sampleCount);
+                bench::KeepAlive(output[sampleCount / 2]);
+            });
+        });
+
+        // Mixer output path, includes the clamp
+        bench::Register("convert/float_to_int16", [](bench::State& state)
+        {
+            std::vector<float> input(sampleCount);
+            std::vector<sf::Int16> output(sampleCount);
+            for (std::size_t i = 0; i < sampleCount; ++i)
+            {
+                input[i] = (i % 200) * 0.012f - 1.2f;
+            }
+            state.SetItems(double(sampleCount));
+            state.Measure([&]()
+            {
+                FloatToInt16(input.data(), output.data(), sampleCount);
+                bench::KeepAlive(output[sampleCount / 2]);
+            });
+        });
+
+        // 100 vertex fan as drawn every frame, items are vertices
+        bench::Register("focusshape/update_100", [](bench::State& state)
+        {
+            sf::VertexArray shape(sf::PrimitiveType::TriangleFan, 100);
+            float startAngle = 0.f;
+            state.SetItems(100);
+            state.Measure([&]()
+            {
+                startAngle += 0.01f;
+                UpdateFocusShape(shape, {960.f, 540.f}, 400.f, startAngle, startAngle + 1.f, sf::Color(140, 10, 60));
+                bench::KeepAlive(shape[50].position.x);
+            });
+        });
+    }
+}
+
+BENCH_REGISTER(RegisterConvertCases);
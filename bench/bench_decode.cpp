@@ -0,0 +1,108 @@
+//---------------------Decode service streaming at real-time pace---------------------------
+#include "benchmark.h"
+#include "../decodeservice.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <fstream>
+#include <thread>
+#include <vector>
+
+namespace
+{
+    const char* wavPath = "bench/bench_decode.wav";
+    const int fileRate = 44100;
+    const int engineRate = 48000;
+    const int blockSize = 512;
+
+    void WriteLittleEndian(std::ofstream& out, std::uint32_t value, int bytes)
+    {
+        for (int i = 0; i < bytes; ++i)
+        {
+            out.put(static_cast<char>((value >> (8 * i)) & 0xff));
+        }
+    }
+
+    // One second of a 440 Hz tone, 16 bit mono
+    bool WriteToneWav()
+    {
+        std::ofstream out(wavPath, std::ios::binary);
+        if (!out)
+            return false;
+
+        const std::uint32_t dataBytes = fileRate * 2;
+        out.write("RIFF", 4);
+        WriteLittleEndian(out, 36 + dataBytes, 4);
+        out.write("WAVEfmt ", 8);
+        WriteLittleEndian(out, 16, 4);
+        WriteLittleEndian(out, 1, 2);
+        WriteLittleEndian(out, 1, 2);
+        WriteLittleEndian(out, fileRate, 4);
+        WriteLittleEndian(out, fileRate * 2, 4);
+        WriteLittleEndian(out, 2, 2);
+        WriteLittleEndian(out, 16, 2);
+        out.write("data", 4);
+        WriteLittleEndian(out, dataBytes, 4);
+        for (int i = 0; i < fileRate; ++i)
+        {
+            double sample = 0.5 * std::sin(2.0 * 3.14159265358979 * 440.0 * i / fileRate);
+            WriteLittleEndian(out, static_cast<std::uint16_t>(static_cast<std::int16_t>(sample * 32767.0)), 2);
+        }
+        return bool(out);
+    }
+
+    // A looping stream read one block per block duration for two passes over the file, as the
+    // audio thread does. Only the Read calls are timed, ns/op is their median cost per sample
+    // rather than the pacing sleep. Counters report underruns, which should stay at zero, and how
+    // much the workers decoded.
+    void RunStreamCase(bench::State& state, float prefetchSeconds)
+    {
+        if (!WriteToneWav())
+        {
+            state.Skip("cannot write the test WAV");
+            return;
+        }
+
+        DecodeService decodeService(engineRate, 1);
+        int stream = decodeService.OpenStream(wavPath, prefetchSeconds, true);
+        if (stream < 0)
+        {
+            state.Skip("cannot open the test WAV");
+            return;
+        }
+
+        const auto blockDuration = std::chrono::microseconds(1000000LL * blockSize / engineRate);
+        const int blockCount = 2 * engineRate / blockSize;
+        std::vector<float> block(blockSize);
+        std::vector<double> readSeconds;
+        readSeconds.reserve(blockCount);
+        auto nextBlock = bench::Clock::now();
+        for (int b = 0; b < blockCount; ++b)
+        {
+            nextBlock += blockDuration;
+            std::this_thread::sleep_until(nextBlock);
+            bench::Clock::time_point readStart = bench::Clock::now();
+            decodeService.Read(stream, block.data(), block.size());
+            readSeconds.push_back(std::chrono::duration<double>(bench::Clock::now() - readStart).count());
+        }
+        std::nth_element(readSeconds.begin(), readSeconds.begin() + blockCount / 2, readSeconds.end());
+        state.SetItems(blockSize);
+        state.Report(readSeconds[blockCount / 2]);
+
+        DecodeStreamStats stats = decodeService.GetStats(stream);
+        state.SetCounter("underruns", stats.underruns, 0.0);
+        state.SetCounter("decoded_samples", double(stats.decodedSamples));
+        state.SetCounter("ring_samples", double(stats.capacity));
+        decodeService.CloseStream(stream);
+    }
+
+    void RegisterDecodeCases()
+    {
+        // 50 ms of prefetch is shorter than one 4096 frame chunk resampled to 48 kHz
+        bench::Register("decode/ring_below_chunk", [](bench::State& state) { RunStreamCase(state, 0.05f); });
+        bench::Register("decode/ring_default", [](bench::State& state) { RunStreamCase(state, 0.5f); });
+    }
+}
+
+BENCH_REGISTER(RegisterDecodeCases);
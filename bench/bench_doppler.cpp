@@ -0,0 +1,100 @@
+//---------------------Doppler delay lines, cost per block and interpolation error---------------------------
+#include "benchmark.h"
+#include "../delayline.h"
+#include <algorithm>
+#include <cmath>
+#include <string>
+#include <vector>
+
+namespace
+{
+    const double piVal = 3.14159265358979323846;
+    const double toneHz = 1000.0;
+    const int samplingRate = 48000;
+
+    void RegisterDopplerCases()
+    {
+        const int voiceCounts[] = { 8, 64 };
+        const int blockSizes[] = { 256, 512 };
+        for (int voiceCount : voiceCounts)
+        {
+            for (int blockSize : blockSizes)
+            {
+                std::string name = "doppler/voices" + std::to_string(voiceCount) + "_block" + std::to_string(blockSize);
+
+                // Every voice moving, delays ramp each block the way a moving source drives them
+                bench::Register(name, [voiceCount, blockSize](bench::State& state)
+                {
+                    DelayLineBank delayLines(voiceCount, samplingRate, blockSize);
+                    std::vector<float> input(std::size_t(voiceCount) * blockSize);
+                    std::vector<float> output(input.size());
+                    std::vector<const float*> inputs(voiceCount);
+                    std::vector<float*> outputs(voiceCount);
+                    for (int v = 0; v < voiceCount; ++v)
+                    {
+                        inputs[v] = &input[std::size_t(v) * blockSize];
+                        outputs[v] = &output[std::size_t(v) * blockSize];
+                        delayLines.ResetVoice(v, delayLines.DistanceToDelay(5.f + v));
+                    }
+                    for (std::size_t i = 0; i < input.size(); ++i)
+                    {
+                        input[i] = static_cast<float>(std::sin(2.0 * piVal * toneHz * i / samplingRate));
+                    }
+
+                    int block = 0;
+                    state.SetItems(double(voiceCount) * blockSize);
+                    state.Measure([&]()
+                    {
+                        for (int v = 0; v < voiceCount; ++v)
+                        {
+                            float meters = 5.f + v + 2.f * std::sin(0.05f * block + v);
+                            delayLines.SetTargetDelay(v, delayLines.DistanceToDelay(meters));
+                        }
+                        delayLines.Process(inputs.data(), outputs.data(), blockSize);
+                        ++block;
+                        bench::KeepAlive(output[0]);
+                    });
+
+                    // ns/op is per voice frame, the audio thread has blockSize frames of real time per block
+                    state.SetCounter("block_us", state.nsPerOp * voiceCount * blockSize / 1000.0);
+                    state.SetCounter("cpu_pct", 100.0 * state.nsPerOp * voiceCount * samplingRate / 1e9);
+                });
+            }
+        }
+
+        // A fixed fractional delay on a 1 kHz tone, error against the analytically delayed tone,
+        // held to the -94 dB delayline.h documents
+        bench::Register("doppler/fractional_error", [](bench::State& state)
+        {
+            const int blockSize = 512;
+            const double delay = 123.37;
+            DelayLineBank delayLines(1, samplingRate, blockSize);
+            delayLines.ResetVoice(0, static_cast<float>(delay));
+
+            std::vector<float> input(blockSize);
+            std::vector<float> output(blockSize);
+            const float* inputs[] = { input.data() };
+            float* outputs[] = { output.data() };
+            double maxError = 0.0;
+            long long frame = 0;
+            state.SetItems(blockSize);
+            state.Measure([&]()
+            {
+                for (int i = 0; i < blockSize; ++i)
+                {
+                    input[i] = static_cast<float>(std::sin(2.0 * piVal * toneHz * (frame + i) / samplingRate));
+                }
+                delayLines.Process(inputs, outputs, blockSize);
+                for (int i = 0; i < blockSize && frame > blockSize; ++i)
+                {
+                    double expected = std::sin(2.0 * piVal * toneHz * (frame + i - delay) / samplingRate);
+                    maxError = std::max(maxError, std::abs(output[i] - expected));
+                }
+                frame += blockSize;
+            });
+            state.SetCounter("max_error", maxError, 2e-5);
+        });
+    }
+}
+
+BENCH_REGISTER(RegisterDopplerCases);
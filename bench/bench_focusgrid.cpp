@@ -0,0 +1,88 @@
+//---------------------Focus cone per step, grid index against the full scan---------------------------
+#include "benchmark.h"
+#include "actorfixture.h"
+#include "../focusgrid.h"
+#include <cmath>
+#include <string>
+#include <vector>
+
+namespace
+{
+    const sf::Vector2f worldSize(1920.f, 1080.f);
+    const sf::Vector2f listener(960.f, 540.f);
+    const float timestep = 1.f / 120.f;
+    const float wanderSpeed = 60.f;
+
+    // The mouse circling the listener at a varying distance, cone shape as Simulation derives it
+    void ConeForStep(int step, float& focusRadian, float& sectorWidth, float& radius)
+    {
+        float normalizedDistance = 0.5f + 0.5f * std::sin(step * 0.013f);
+        focusRadian = std::fmod(step * 0.02f, 6.2831853f) - 3.1415926f;
+        radius = 60.f + normalizedDistance * 940.f;
+        sectorWidth = (5.f + (1.f - normalizedDistance) * 235.f) * 3.1415926f / 180.f;
+    }
+
+    void RegisterFocusGridCases()
+    {
+        const int actorCounts[] = { 1000, 10000, 100000 };
+        for (int actorCount : actorCounts)
+        {
+            std::string suffix = "/" + std::to_string(actorCount / 1000) + "k";
+
+            // Reference: UpdateFocus tests every actor every step
+            bench::Register("focus/scan_step" + suffix, [actorCount](bench::State& state)
+            {
+                ActorStore actors = bench::MakeActors(actorCount, worldSize, wanderSpeed);
+                int step = 0;
+                state.SetItems(actorCount);
+                state.Measure([&]()
+                {
+                    float focusRadian, sectorWidth, radius;
+                    ConeForStep(step++, focusRadian, sectorWidth, radius);
+                    actors.Integrate(timestep, { 0.f, 0.f }, worldSize);
+                    actors.UpdateListenerDistance(listener);
+                    actors.UpdateFocus(listener, focusRadian, sectorWidth, radius);
+                });
+            });
+
+            // The grid re-files one slice and tests only the cone's edge cells
+            bench::Register("focus/grid_step" + suffix, [actorCount](bench::State& state)
+            {
+                ActorStore actors = bench::MakeActors(actorCount, worldSize, wanderSpeed);
+                FocusGrid grid(worldSize);
+                float maxMove = wanderSpeed * std::sqrt(2.f) * timestep;
+                int step = 0;
+                double tested = 0.0;
+                double hits = 0.0;
+                state.SetItems(actorCount);
+                state.Measure([&]()
+                {
+                    float focusRadian, sectorWidth, radius;
+                    ConeForStep(step++, focusRadian, sectorWidth, radius);
+                    actors.Integrate(timestep, { 0.f, 0.f }, worldSize);
+                    actors.UpdateListenerDistance(listener);
+                    grid.Update(actors.posX.data(), actors.posY.data(), actors.Size(), maxMove);
+                    hits += grid.QuerySector(actors.posX.data(), actors.posY.data(), actors.listenerDistance.data(), listener,
+                                             focusRadian, sectorWidth, radius, actors.inFocus.data()).size();
+                    tested += grid.GetTestedCount();
+                });
+                state.SetCounter("tested_pct", 100.0 * tested / (double(step) * actorCount));
+                state.SetCounter("in_cone_pct", 100.0 * hits / (double(step) * actorCount));
+
+                // Same answer as the scan on the final state
+                std::vector<std::uint8_t> gridFocus(actors.inFocus);
+                float focusRadian, sectorWidth, radius;
+                ConeForStep(step - 1, focusRadian, sectorWidth, radius);
+                actors.UpdateFocus(listener, focusRadian, sectorWidth, radius);
+                double mismatches = 0.0;
+                for (std::size_t i = 0; i < gridFocus.size(); ++i)
+                {
+                    mismatches += gridFocus[i] != actors.inFocus[i];
+                }
+                state.SetCounter("mismatches", mismatches, 0.0);
+            });
+        }
+    }
+}
+
+BENCH_REGISTER(RegisterFocusGridCases);
@@ -0,0 +1,85 @@
+//---------------------Grid layer frame time, idle mouse versus moving focus---------------------------
+#include "benchmark.h"
+#include "../gridlayer.h"
+#include "../PerlinNoise.hpp"
+#include <functional>
+#include <vector>
+
+namespace
+{
+    const unsigned width = 1920;
+    const unsigned height = 1080;
+    const int gridReso = 20;
+    const int cols = width / gridReso;
+    const int rows = height / gridReso;
+
+    std::vector<float> MakeRotationAngles()
+    {
+        std::vector<float> rotationAngles(cols * rows);
+        siv::PerlinNoise perlin;
+        for (int y = 0; y < rows; ++y)
+        {
+            for (int x = 0; x < cols; ++x)
+            {
+                rotationAngles[y * cols + x] = static_cast<float>(perlin.noise2D_01(x * 0.05, y * 0.05) * 360.0);
+            }
+        }
+        return rotationAngles;
+    }
+
+    // Draws the layer into an offscreen target, display() flushes the GL command stream
+    void RunGridCase(bench::State& state, std::function<float(int)> focusDegree)
+    {
+        sf::RenderTexture target;
+        if (!target.create(width, height))
+        {
+            state.Skip("no GL context for an offscreen target");
+            return;
+        }
+
+        std::vector<float> rotationAngles = MakeRotationAngles();
+        GridLayer layer;
+        layer.SetAngleThreshold(0.5f);
+        layer.Configure(rotationAngles, cols, rows, gridReso, {width, height});
+
+        int frame = 0;
+        state.Measure([&]()
+        {
+            target.clear(sf::Color::Black);
+            layer.Draw(target, focusDegree(frame++));
+            target.display();
+        });
+        state.SetCounter("cache_hits", double(layer.GetCacheHits()));
+        state.SetCounter("rerenders", double(layer.GetRerenders()));
+    }
+
+    void RegisterGridLayerCases()
+    {
+        // CPU side of a re-render, items are glyph vertices
+        bench::Register("gridlayer/build_glyphs", [](bench::State& state)
+        {
+            std::vector<float> rotationAngles = MakeRotationAngles();
+            sf::VertexArray glyphs(sf::PrimitiveType::Points, rotationAngles.size() * gridReso);
+            GridGlyphScratch scratch;
+            float focusDegree = 0.f;
+            state.SetItems(double(glyphs.getVertexCount()));
+            state.Measure([&]()
+            {
+                focusDegree += 1.f;
+                BuildGridGlyphs(glyphs, rotationAngles, cols, rows, gridReso, {width, height}, focusDegree, scratch);
+                bench::KeepAlive(glyphs[1].position.x);
+            });
+        });
+
+        // Mouse idle, the focus angle stays put
+        bench::Register("gridlayer/idle_frame", [](bench::State& state) { RunGridCase(state, [](int) { return 42.f; }); });
+
+        // Mouse sweeping, every frame moves the focus angle past the threshold and rebuilds the geometry
+        bench::Register("gridlayer/moving_frame", [](bench::State& state) { RunGridCase(state, [](int frame) { return frame * 2.f; }); });
+
+        // Sub-threshold jitter, a hand resting on the mouse
+        bench::Register("gridlayer/jitter_frame", [](bench::State& state) { RunGridCase(state, [](int frame) { return 42.f + (frame % 2) * 0.2f; }); });
+    }
+}
+
+BENCH_REGISTER(RegisterGridLayerCases);
@@ -0,0 +1,197 @@
+//---------------------Benchmark suite runner, JSON output and baseline comparison---------------------------
+#include "benchmark.h"
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <string>
+
+namespace
+{
+    struct Options
+    {
+        std::string filter;
+        std::string jsonPath;
+        std::string baselinePath;
+        double thresholdPercent = 10.0;
+        double minSeconds = 0.25;
+    };
+
+    void PrintUsage()
+    {
+        std::cout << "usage: bench_suite [--filter text] [--json out.json] [--baseline base.json] [--threshold percent] [--min-time seconds] [--list]\n";
+    }
+
+    std::string Escape(const std::string& text)
+    {
+        std::string escaped;
+        for (char c : text)
+        {
+            if (c == '"' || c == '\\')
+                escaped += '\\';
+            escaped += c;
+        }
+        return escaped;
+    }
+
+    // Reads back what WriteJson writes, one case per line, so no general JSON parser is needed
+    std::map<std::string, double> ReadBaseline(const std::string& path)
+    {
+        std::map<std::string, double> baseline;
+        std::ifstream in(path);
+        std::string line;
+        while (std::getline(in, line))
+        {
+            std::size_t nameStart = line.find("\"name\": \"");
+            std::size_t nsStart = line.find("\"ns_per_op\": ");
+            if (nameStart == std::string::npos || nsStart == std::string::npos)
+                continue;
+            nameStart += 9;
+            std::size_t nameEnd = line.find('"', nameStart);
+            baseline[line.substr(nameStart, nameEnd - nameStart)] = std::atof(line.c_str() + nsStart + 13);
+        }
+        return baseline;
+    }
+
+    struct Result
+    {
+        std::string name;
+        bench::State state;
+    };
+
+    bool WriteJson(const std::string& path, const std::vector<Result>& results)
+    {
+        std::ofstream out(path);
+        if (!out)
+        {
+            std::cerr << "Failed to write benchmark results: " << path << std::endl;
+            return false;
+        }
+
+        out << std::setprecision(9);
+        out << "{\n  \"benchmarks\": [\n";
+        for (std::size_t i = 0; i < results.size(); ++i)
+        {
+            const bench::State& state = results[i].state;
+            out << "    {\"name\": \"" << Escape(results[i].name) << "\", ";
+            if (state.skipped)
+            {
+                out << "\"skipped\": \"" << Escape(state.skipReason) << "\"";
+            }
+            else
+            {
+                out << "\"ns_per_op\": " << state.nsPerOp << ", \"items_per_second\": " << state.itemsPerSecond;
+                for (const auto& counter : state.counters)
+                {
+                    out << ", \"" << Escape(counter.first) << "\": " << counter.second;
+                }
+            }
+            if (!state.failures.empty())
+                out << ", \"failed\": \"" << Escape(state.failures.front()) << "\"";
+            out << "}" << (i + 1 < results.size() ? "," : "") << "\n";
+        }
+        out << "  ]\n}\n";
+        return true;
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    Options options;
+    bool listOnly = false;
+    for (int i = 1; i < argc; ++i)
+    {
+        std::string arg = argv[i];
+        if (arg == "--filter" && i + 1 < argc)
+            options.filter = argv[++i];
+        else if (arg == "--json" && i + 1 < argc)
+            options.jsonPath = argv[++i];
+        else if (arg == "--baseline" && i + 1 < argc)
+            options.baselinePath = argv[++i];
+        else if (arg == "--threshold" && i + 1 < argc)
+            options.thresholdPercent = std::atof(argv[++i]);
+        else if (arg == "--min-time" && i + 1 < argc)
+            options.minSeconds = std::atof(argv[++i]);
+        else if (arg == "--list")
+            listOnly = true;
+        else
+        {
+            PrintUsage();
+            return 1;
+        }
+    }
+
+    std::map<std::string, double> baseline;
+    if (!options.baselinePath.empty())
+        baseline = ReadBaseline(options.baselinePath);
+
+    std::vector<Result> results;
+    int regressions = 0;
+    int failed = 0;
+
+    if (!listOnly)
+    {
+        std::cout << std::left << std::setw(40) << "case" << std::right << std::setw(14) << "ns/op" << std::setw(16) << "items/s"
+                  << (baseline.empty() ? "" : "    vs baseline") << "\n";
+    }
+    for (const bench::Case& benchCase : bench::Registry())
+    {
+        if (!options.filter.empty() && benchCase.name.find(options.filter) == std::string::npos)
+            continue;
+        if (listOnly)
+        {
+            std::cout << benchCase.name << "\n";
+            continue;
+        }
+
+        Result result{ benchCase.name, bench::State(options.minSeconds) };
+        benchCase.run(result.state);
+        const bench::State& state = result.state;
+        failed += !state.failures.empty();
+
+        std::cout << std::left << std::setw(40) << benchCase.name << std::right;
+        if (state.skipped || !state.measured)
+        {
+            std::cout << "  skipped: " << (state.skipped ? state.skipReason : "nothing measured") << "\n";
+            for (const std::string& reason : state.failures)
+            {
+                std::cout << "    FAILED: " << reason << "\n";
+            }
+            results.push_back(std::move(result));
+            continue;
+        }
+
+        std::cout << std::fixed << std::setprecision(2) << std::setw(14) << state.nsPerOp
+                  << std::scientific << std::setw(16) << state.itemsPerSecond << std::fixed;
+
+        auto base = baseline.find(benchCase.name);
+        if (base != baseline.end() && base->second > 0.0)
+        {
+            double change = 100.0 * (state.nsPerOp - base->second) / base->second;
+            bool regressed = change > options.thresholdPercent;
+            regressions += regressed;
+            std::cout << std::setw(10) << std::showpos << change << std::noshowpos << "%" << (regressed ? "  REGRESSION" : "");
+        }
+        for (const auto& counter : state.counters)
+        {
+            std::cout << "  " << counter.first << "=" << std::defaultfloat << counter.second << std::fixed;
+        }
+        std::cout << "\n";
+        for (const std::string& reason : state.failures)
+        {
+            std::cout << "    FAILED: " << reason << "\n";
+        }
+        results.push_back(std::move(result));
+    }
+
+    if (!options.jsonPath.empty() && !listOnly)
+        WriteJson(options.jsonPath, results);
+
+    if (failed > 0)
+        std::cout << failed << " case(s) failed a correctness limit" << std::endl;
+    if (regressions > 0)
+        std::cout << regressions << " case(s) slower than baseline by more than " << options.thresholdPercent << "%" << std::endl;
+    return failed > 0 || regressions > 0 ? 1 : 0;
+}
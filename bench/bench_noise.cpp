@@ -0,0 +1,216 @@
+//---------------------Perlin and simplex noise sampling over the background grid---------------------------
+#include "benchmark.h"
+#include "../PerlinNoise.hpp"
+#include "../SimplexNoise.hpp"
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace
+{
+    // Same grid main() samples for the flow field, 96 x 54 cells at 0.05 spacing
+    const int cols = 96;
+    const int rows = 54;
+    const double step = 0.05;
+    // One grid's worth of points scattered over the field, the access pattern of particles
+    const int scatteredCount = cols * rows;
+
+    template <typename Noise>
+    void RegisterEngineCases(const std::string& prefix)
+    {
+        bench::Register(prefix + "/noise2D", [](bench::State& state)
+        {
+            Noise noise(1234);
+            state.SetItems(cols * rows);
+            state.Measure([&]()
+            {
+                double sum = 0.0;
+                for (int y = 0; y < rows; ++y)
+                {
+                    for (int x = 0; x < cols; ++x)
+                    {
+                        sum += noise.noise2D(x * step, y * step);
+                    }
+                }
+                bench::KeepAlive(sum);
+            });
+        });
+
+        bench::Register(prefix + "/octave2D_4", [](bench::State& state)
+        {
+            Noise noise(1234);
+            state.SetItems(cols * rows);
+            state.Measure([&]()
+            {
+                double sum = 0.0;
+                for (int y = 0; y < rows; ++y)
+                {
+                    for (int x = 0; x < cols; ++x)
+                    {
+                        sum += noise.octave2D(x * step, y * step, 4);
+                    }
+                }
+                bench::KeepAlive(sum);
+            });
+        });
+
+        // Animated field, the grid advanced along z once per call
+        bench::Register(prefix + "/noise3D", [](bench::State& state)
+        {
+            Noise noise(1234);
+            double time = 0.0;
+            state.SetItems(cols * rows);
+            state.Measure([&]()
+            {
+                double sum = 0.0;
+                for (int y = 0; y < rows; ++y)
+                {
+                    for (int x = 0; x < cols; ++x)
+                    {
+                        sum += noise.noise3D(x * step, y * step, time);
+                    }
+                }
+                time += 0.01;
+                bench::KeepAlive(sum);
+            });
+        });
+
+        // Incoherent points, neighbouring samples share no lattice cell
+        bench::Register(prefix + "/noise3D_scattered", [](bench::State& state)
+        {
+            Noise noise(1234);
+            std::mt19937 rng(42);
+            std::uniform_real_distribution<double> coordinate(0.0, cols * step);
+            std::vector<double> points(scatteredCount * 3);
+            for (double& point : points)
+            {
+                point = coordinate(rng);
+            }
+            state.SetItems(scatteredCount);
+            state.Measure([&]()
+            {
+                double sum = 0.0;
+                for (int i = 0; i < scatteredCount; ++i)
+                {
+                    sum += noise.noise3D(points[i * 3], points[i * 3 + 1], points[i * 3 + 2]);
+                }
+                bench::KeepAlive(sum);
+            });
+        });
+    }
+
+    // Range and continuity over scattered points. Each point is paired with one 1e-6 away in a random
+    // direction: max_abs must stay within 1, and max_slope, the largest change over that step divided
+    // by the step, stays in the single digits for a continuous field. A seam shows up in the thousands.
+    template <typename Noise>
+    void RegisterCheckCase(const std::string& name, int dimensions)
+    {
+        bench::Register(name, [dimensions](bench::State& state)
+        {
+            Noise noise(1234);
+            std::mt19937 rng(7);
+            std::uniform_real_distribution<double> coordinate(-64.0, 64.0);
+            std::uniform_real_distribution<double> direction(-1.0, 1.0);
+            const double h = 1e-6;
+            double maxAbs = 0.0;
+            double maxSlope = 0.0;
+            state.SetItems(scatteredCount);
+            state.Measure([&]()
+            {
+                for (int i = 0; i < scatteredCount; ++i)
+                {
+                    double x = coordinate(rng), y = coordinate(rng), z = coordinate(rng);
+                    double dx = direction(rng), dy = direction(rng), dz = dimensions == 3 ? direction(rng) : 0.0;
+                    double length = std::sqrt(dx * dx + dy * dy + dz * dz) + 1e-12;
+                    double a = dimensions == 3 ? noise.noise3D(x, y, z) : noise.noise2D(x, y);
+                    double b = dimensions == 3 ? noise.noise3D(x + dx / length * h, y + dy / length * h, z + dz / length * h)
+                                               : noise.noise2D(x + dx / length * h, y + dy / length * h);
+                    maxAbs = std::max(maxAbs, std::abs(a));
+                    maxSlope = std::max(maxSlope, std::abs(b - a) / h);
+                }
+            });
+            state.SetCounter("max_abs", maxAbs);
+            state.SetCounter("max_slope", maxSlope);
+        });
+    }
+
+    // Flow vectors over the grid, the analytic gradient against forward differences at 3 samples a cell
+    void RegisterDerivativeCases()
+    {
+        bench::Register("perlin/noise2D_deriv", [](bench::State& state)
+        {
+            siv::PerlinNoise noise(1234);
+            state.SetItems(cols * rows);
+            state.Measure([&]()
+            {
+                double sum = 0.0;
+                for (int y = 0; y < rows; ++y)
+                {
+                    for (int x = 0; x < cols; ++x)
+                    {
+                        std::array<double, 3> d = noise.noise2D_deriv(x * step, y * step);
+                        sum += d[0] + d[1] + d[2];
+                    }
+                }
+                bench::KeepAlive(sum);
+            });
+        });
+
+        bench::Register("perlin/noise2D_finite_diff", [](bench::State& state)
+        {
+            siv::PerlinNoise noise(1234);
+            const double h = 1e-4;
+            state.SetItems(cols * rows);
+            state.Measure([&]()
+            {
+                double sum = 0.0;
+                for (int y = 0; y < rows; ++y)
+                {
+                    for (int x = 0; x < cols; ++x)
+                    {
+                        double value = noise.noise2D(x * step, y * step);
+                        double dx = (noise.noise2D(x * step + h, y * step) - value) / h;
+                        double dy = (noise.noise2D(x * step, y * step + h) - value) / h;
+                        sum += value + dx + dy;
+                    }
+                }
+                bench::KeepAlive(sum);
+            });
+        });
+
+        bench::Register("perlin/curl2D", [](bench::State& state)
+        {
+            siv::PerlinNoise noise(1234);
+            state.SetItems(cols * rows);
+            state.Measure([&]()
+            {
+                double sum = 0.0;
+                for (int y = 0; y < rows; ++y)
+                {
+                    for (int x = 0; x < cols; ++x)
+                    {
+                        std::array<double, 2> v = noise.curl2D(x * step, y * step);
+                        sum += v[0] + v[1];
+                    }
+                }
+                bench::KeepAlive(sum);
+            });
+        });
+    }
+
+    void RegisterNoiseCases()
+    {
+        RegisterEngineCases<siv::PerlinNoise>("perlin");
+        RegisterEngineCases<siv::SimplexNoise>("simplex");
+        RegisterDerivativeCases();
+        RegisterCheckCase<siv::PerlinNoise>("perlin/check2D", 2);
+        RegisterCheckCase<siv::PerlinNoise>("perlin/check3D", 3);
+        RegisterCheckCase<siv::SimplexNoise>("simplex/check2D", 2);
+        RegisterCheckCase<siv::SimplexNoise>("simplex/check3D", 3);
+    }
+}
+
+BENCH_REGISTER(RegisterNoiseCases);
@@ -0,0 +1,79 @@
+//---------------------Occlusion grid build and query (10k segments, 256 sources)---------------------------
+#include "benchmark.h"
+#include "../occlusion.h"
+#include <random>
+#include <vector>
+
+namespace
+{
+    const int segmentCount = 10000;
+    const int sourceCount = 256;
+    const sf::Vector2f worldMin(0.f, 0.f);
+    const sf::Vector2f worldMax(1920.f, 1080.f);
+
+    struct OcclusionScene
+    {
+        std::vector<OccluderSegment> segments;
+        std::vector<sf::Vector2f> sources;
+        sf::Vector2f listener;
+    };
+
+    // Short wall pieces scattered over the screen, similar to a dense level
+    OcclusionScene MakeScene()
+    {
+        std::mt19937 rng(1234);
+        std::uniform_real_distribution<float> randX(worldMin.x, worldMax.x);
+        std::uniform_real_distribution<float> randY(worldMin.y, worldMax.y);
+        std::uniform_real_distribution<float> randOffset(-30.f, 30.f);
+
+        OcclusionScene scene;
+        scene.segments.reserve(segmentCount);
+        for (int i = 0; i < segmentCount; ++i)
+        {
+            sf::Vector2f a(randX(rng), randY(rng));
+            sf::Vector2f b(a.x + randOffset(rng), a.y + randOffset(rng));
+            scene.segments.push_back({ a, b, 0.5f });
+        }
+        for (int i = 0; i < sourceCount; ++i)
+        {
+            scene.sources.emplace_back(randX(rng), randY(rng));
+        }
+        scene.listener = sf::Vector2f(worldMax.x * 0.5f, worldMax.y * 0.5f);
+        return scene;
+    }
+
+    void RegisterOcclusionCases()
+    {
+        bench::Register("occlusion/build_10k_segments", [](bench::State& state)
+        {
+            OcclusionScene scene = MakeScene();
+            OccluderGrid grid;
+            state.SetItems(segmentCount);
+            state.Measure([&]() { grid.Build(scene.segments, worldMin, worldMax, 24.f); });
+        });
+
+        bench::Register("occlusion/query_256_sources", [](bench::State& state)
+        {
+            OcclusionScene scene = MakeScene();
+            OccluderGrid grid;
+            grid.Build(scene.segments, worldMin, worldMax, 24.f);
+            std::vector<OcclusionResult> results(sourceCount);
+
+            state.SetItems(sourceCount);
+            state.Measure([&]()
+            {
+                grid.Query(scene.listener, scene.sources.data(), scene.sources.size(), results.data());
+                bench::KeepAlive(results[0].transmission);
+            });
+
+            int occluded = 0;
+            for (const OcclusionResult& result : results)
+            {
+                occluded += result.occlusion == 0.f;
+            }
+            state.SetCounter("occluded", occluded);
+        });
+    }
+}
+
+BENCH_REGISTER(RegisterOcclusionCases);
@@ -0,0 +1,102 @@
+//---------------------Particle advection frame time by particle and thread count---------------------------
+#include "benchmark.h"
+#include "../particlefield.h"
+#include "../PerlinNoise.hpp"
+#include <algorithm>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace
+{
+    const unsigned width = 1920;
+    const unsigned height = 1080;
+    const int gridReso = 20;
+    const int cols = width / gridReso;
+    const int rows = height / gridReso;
+    // One 60 Hz frame per call
+    const float frameSeconds = 1.f / 60.f;
+
+    std::vector<float> MakeRotationAngles()
+    {
+        std::vector<float> rotationAngles(cols * rows);
+        siv::PerlinNoise perlin;
+        for (int y = 0; y < rows; ++y)
+        {
+            for (int x = 0; x < cols; ++x)
+            {
+                rotationAngles[y * cols + x] = static_cast<float>(perlin.noise2D_01(x * 0.05, y * 0.05) * 360.0);
+            }
+        }
+        return rotationAngles;
+    }
+
+    // CPU side of one frame: advection plus the vertex array fill, items are particles
+    void RunUpdateCase(bench::State& state, std::size_t count, int threadCount)
+    {
+        std::vector<float> rotationAngles = MakeRotationAngles();
+        ParticleField particles(threadCount);
+        particles.Reset(count, {float(width), float(height)});
+        particles.SetField(rotationAngles, cols, rows, float(gridReso));
+        sf::VertexArray vertices;
+
+        state.SetItems(double(count));
+        state.Measure([&]()
+        {
+            particles.Update(frameSeconds, vertices);
+            bench::KeepAlive(vertices[count - 1].position.x);
+        });
+        state.SetCounter("threads", particles.GetThreadCount());
+        state.SetCounter("frame_ms", state.nsPerOp * count * 1e-6);
+    }
+
+    // Full frame including the point upload and draw into an offscreen target
+    void RunDrawCase(bench::State& state, std::size_t count)
+    {
+        sf::RenderTexture target;
+        if (!target.create(width, height))
+        {
+            state.Skip("no GL context for an offscreen target");
+            return;
+        }
+
+        std::vector<float> rotationAngles = MakeRotationAngles();
+        ParticleField particles;
+        particles.Reset(count, {float(width), float(height)});
+        particles.SetField(rotationAngles, cols, rows, float(gridReso));
+        sf::VertexArray vertices;
+
+        state.SetItems(double(count));
+        state.Measure([&]()
+        {
+            particles.Update(frameSeconds, vertices);
+            target.clear(sf::Color::Black);
+            target.draw(vertices);
+            target.display();
+        });
+        state.SetCounter("threads", particles.GetThreadCount());
+        state.SetCounter("frame_ms", state.nsPerOp * count * 1e-6);
+    }
+
+    void RegisterParticleCases()
+    {
+        const std::size_t counts[] = { 25000, 100000, 250000, 1000000 };
+        const int hardwareThreads = static_cast<int>(std::min(8u, std::max(1u, std::thread::hardware_concurrency())));
+        std::vector<int> threadCounts = { 1, 2, 4 };
+        if (hardwareThreads > 4)
+            threadCounts.push_back(hardwareThreads);
+
+        for (std::size_t count : counts)
+        {
+            for (int threadCount : threadCounts)
+            {
+                bench::Register("particles/update_" + std::to_string(count / 1000) + "k_t" + std::to_string(threadCount),
+                                [count, threadCount](bench::State& state) { RunUpdateCase(state, count, threadCount); });
+            }
+            bench::Register("particles/draw_" + std::to_string(count / 1000) + "k",
+                            [count](bench::State& state) { RunDrawCase(state, count); });
+        }
+    }
+}
+
+BENCH_REGISTER(RegisterParticleCases);
@@ -0,0 +1,146 @@
+//---------------------Steam Audio processing cost and block size against latency---------------------------
+#include "benchmark.h"
+#include <string>
+
+namespace
+{
+    // Case names shared by both builds, so one without the SDK skips exactly the cases it lacks
+    const char* processAudioCase = "steamaudio/process_audio_1s";
+    const int blockSizes[] = { 64, 128, 256, 512, 1024, 2048 };
+
+    std::string BlockCaseName(int blockSize)
+    {
+        return "steamaudio/voices8_block" + std::to_string(blockSize);
+    }
+}
+
+#ifndef BENCH_NO_STEAMAUDIO
+#include "../steamaudiomanager.h"
+#include "../resampler.h"
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+namespace
+{
+    // Mirrors SpatialMixer: a trigger waits one block, then sits behind two queued blocks
+    const int latencyBlocks = 3;
+    const int voiceCount = 8;
+    const int samplingRate = 48000;
+    const int assetRate = 44100;
+
+    bool InitializeOrSkip(SteamAudioManager& steamAudio, int frameSize, bench::State& state)
+    {
+        AudioConfig config;
+        config.samplingRate = samplingRate;
+        config.frameSize = frameSize;
+        SteamAudioVoice probe;
+        if (!steamAudio.Initialize(config) || !steamAudio.CreateVoice(probe))
+        {
+            state.Skip("Steam Audio failed to initialize");
+            return false;
+        }
+        steamAudio.ReleaseVoice(probe);
+        return true;
+    }
+
+    void RegisterSteamAudioCases()
+    {
+        // Whole clip path, one second of audio per call
+        bench::Register(processAudioCase, [](bench::State& state)
+        {
+            SteamAudioManager steamAudio;
+            if (!InitializeOrSkip(steamAudio, 1024, state))
+                return;
+
+            std::vector<float> clip(samplingRate / 1024 * 1024);
+            for (std::size_t i = 0; i < clip.size(); ++i)
+            {
+                clip[i] = std::sin(0.03f * i);
+            }
+            state.SetItems(double(clip.size()));
+            state.Measure([&]()
+            {
+                std::vector<float> output = steamAudio.ProcessAudio(clip, {1.f, 0.f, 0.f});
+                bench::KeepAlive(output[0]);
+            });
+            steamAudio.CleanUp();
+        });
+
+        // Per block: 8 voices plus one resampled stream, the work SpatialMixer does per callback
+        for (int blockSize : blockSizes)
+        {
+            bench::Register(BlockCaseName(blockSize), [blockSize](bench::State& state)
+            {
+                SteamAudioManager steamAudio;
+                if (!InitializeOrSkip(steamAudio, blockSize, state))
+                    return;
+
+                std::vector<SteamAudioVoice> voices(voiceCount);
+                for (SteamAudioVoice& voice : voices)
+                {
+                    steamAudio.CreateVoice(voice);
+                }
+
+                PolyphaseResampler resampler(assetRate, samplingRate);
+                std::vector<float> streamInput(static_cast<std::size_t>(std::ceil(double(blockSize) * assetRate / samplingRate)));
+                std::vector<float> streamOutput;
+                std::vector<float> input(blockSize);
+                std::vector<float> voiceOutput(blockSize * 2);
+                std::vector<float> mix(blockSize * 2);
+                for (int i = 0; i < blockSize; ++i)
+                {
+                    input[i] = std::sin(0.03f * i);
+                }
+
+                int block = 0;
+                state.SetItems(blockSize);
+                state.Measure([&]()
+                {
+                    streamOutput.clear();
+                    resampler.Process(streamInput.data(), streamInput.size(), streamOutput);
+
+                    std::fill(mix.begin(), mix.end(), 0.f);
+                    for (int v = 0; v < voiceCount; ++v)
+                    {
+                        float angle = 0.1f * block + v;
+                        steamAudio.ProcessBlock(voices[v], input.data(), voiceOutput.data(), { std::cos(angle), 0.f, std::sin(angle) });
+                        for (int i = 0; i < blockSize * 2; ++i)
+                        {
+                            mix[i] += voiceOutput[i];
+                        }
+                    }
+                    ++block;
+                    bench::KeepAlive(mix[0]);
+                });
+
+                // ns/op is per output frame, the real time budget per frame is 1e9 / rate
+                state.SetCounter("latency_ms", 1000.0 * latencyBlocks * blockSize / samplingRate);
+                state.SetCounter("cpu_pct", 100.0 * state.nsPerOp * samplingRate / 1e9);
+
+                for (SteamAudioVoice& voice : voices)
+                {
+                    steamAudio.ReleaseVoice(voice);
+                }
+                steamAudio.CleanUp();
+            });
+        }
+    }
+}
+#else
+namespace
+{
+    // Built without the SDK, the cases still show up in the report as skipped
+    void RegisterSteamAudioCases()
+    {
+        auto skip = [](bench::State& state) { state.Skip("Steam Audio not found at build time"); };
+        bench::Register(processAudioCase, skip);
+        for (int blockSize : blockSizes)
+        {
+            bench::Register(BlockCaseName(blockSize), skip);
+        }
+    }
+}
+#endif
+
+BENCH_REGISTER(RegisterSteamAudioCases);
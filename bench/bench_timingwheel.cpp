@@ -0,0 +1,51 @@
+//---------------------Timing wheel schedule and drain cost for radar echoes---------------------------
+#include "benchmark.h"
+#include "../timingwheel.h"
+#include <cstdint>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace
+{
+    const int samplingRate = 48000;
+    const int blockSize = 512;
+
+    void RegisterTimingWheelCases()
+    {
+        // One pulse worth of echoes spread over the ring's 0.4 s flight, then drained block by block
+        const int echoCounts[] = { 1000, 4096, 16384 };
+        for (int echoCount : echoCounts)
+        {
+            bench::Register("timingwheel/pulse_" + std::to_string(echoCount), [echoCount](bench::State& state)
+            {
+                std::mt19937 rng(42);
+                std::uniform_int_distribution<int> delay(0, samplingRate * 2 / 5);
+                std::vector<std::uint32_t> delays(echoCount);
+                for (std::uint32_t& value : delays)
+                {
+                    value = static_cast<std::uint32_t>(delay(rng));
+                }
+
+                TimingWheel<float> wheel(echoCount);
+                float sum = 0.f;
+                state.SetItems(echoCount);
+                state.Measure([&]()
+                {
+                    std::uint64_t now = wheel.GetNow();
+                    for (std::uint32_t value : delays)
+                    {
+                        wheel.Schedule(now + value, 1.f);
+                    }
+                    while (wheel.GetPending() > 0)
+                    {
+                        wheel.Advance(wheel.GetNow() + blockSize, [&sum](std::uint64_t, float gain) { sum += gain; });
+                    }
+                    bench::KeepAlive(sum);
+                });
+            });
+        }
+    }
+}
+
+BENCH_REGISTER(RegisterTimingWheelCases);
@@ -0,0 +1,149 @@
+//---------------------Fast trig accuracy and speed against libm---------------------------
+#include "benchmark.h"
+#include "../fasttrig.h"
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <vector>
+
+namespace
+{
+    const std::size_t count = 1 << 16;
+    const float sinCosRange = 8192.f;
+
+    struct TrigInputs
+    {
+        std::vector<float> angles;
+        std::vector<float> ys;
+        std::vector<float> xs;
+        std::vector<float> first;
+        std::vector<float> second;
+    };
+
+    TrigInputs MakeInputs()
+    {
+        std::mt19937 rng(7);
+        std::uniform_real_distribution<float> randAngle(-sinCosRange, sinCosRange);
+        std::uniform_real_distribution<float> randCoord(-1000.f, 1000.f);
+
+        TrigInputs inputs;
+        inputs.angles.resize(count);
+        inputs.ys.resize(count);
+        inputs.xs.resize(count);
+        inputs.first.resize(count);
+        inputs.second.resize(count);
+        for (std::size_t i = 0; i < count; ++i)
+        {
+            inputs.angles[i] = randAngle(rng);
+            inputs.ys[i] = randCoord(rng);
+            inputs.xs[i] = randCoord(rng);
+        }
+        // Exact axes and the origin are the usual atan2 trouble spots
+        inputs.ys[0] = 0.f; inputs.xs[0] = 0.f;
+        inputs.ys[1] = 0.f; inputs.xs[1] = -5.f;
+        inputs.ys[2] = 5.f; inputs.xs[2] = 0.f;
+        inputs.ys[3] = -5.f; inputs.xs[3] = 0.f;
+        return inputs;
+    }
+
+    void RegisterTrigCases()
+    {
+        bench::Register("trig/sincos_libm", [](bench::State& state)
+        {
+            TrigInputs in = MakeInputs();
+            state.SetItems(count);
+            state.Measure([&]()
+            {
+                for (std::size_t i = 0; i < count; ++i)
+                {
+                    in.first[i] = std::sin(in.angles[i]);
+                    in.second[i] = std::cos(in.angles[i]);
+                }
+                bench::KeepAlive(in.first[count / 2]);
+            });
+        });
+
+        bench::Register("trig/sincos_scalar", [](bench::State& state)
+        {
+            TrigInputs in = MakeInputs();
+            state.SetItems(count);
+            state.Measure([&]()
+            {
+                for (std::size_t i = 0; i < count; ++i)
+                {
+                    fasttrig::SinCos(in.angles[i], in.first[i], in.second[i]);
+                }
+                bench::KeepAlive(in.first[count / 2]);
+            });
+        });
+
+        // Accuracy rides along on the batch cases against double precision libm, held to the bounds
+        // fasttrig.h documents
+        bench::Register("trig/sincos_batch", [](bench::State& state)
+        {
+            TrigInputs in = MakeInputs();
+            state.SetItems(count);
+            state.Measure([&]()
+            {
+                fasttrig::SinCosBatch(in.angles.data(), in.first.data(), in.second.data(), count);
+                bench::KeepAlive(in.first[count / 2]);
+            });
+
+            double maxError = 0.0;
+            for (std::size_t i = 0; i < count; ++i)
+            {
+                maxError = std::max(maxError, std::abs(in.first[i] - std::sin(double(in.angles[i]))));
+                maxError = std::max(maxError, std::abs(in.second[i] - std::cos(double(in.angles[i]))));
+            }
+            state.SetCounter("max_error", maxError, 1e-7);
+        });
+
+        bench::Register("trig/atan2_libm", [](bench::State& state)
+        {
+            TrigInputs in = MakeInputs();
+            state.SetItems(count);
+            state.Measure([&]()
+            {
+                for (std::size_t i = 0; i < count; ++i)
+                {
+                    in.first[i] = std::atan2(in.ys[i], in.xs[i]);
+                }
+                bench::KeepAlive(in.first[count / 2]);
+            });
+        });
+
+        bench::Register("trig/atan2_scalar", [](bench::State& state)
+        {
+            TrigInputs in = MakeInputs();
+            state.SetItems(count);
+            state.Measure([&]()
+            {
+                for (std::size_t i = 0; i < count; ++i)
+                {
+                    in.first[i] = fasttrig::Atan2(in.ys[i], in.xs[i]);
+                }
+                bench::KeepAlive(in.first[count / 2]);
+            });
+        });
+
+        bench::Register("trig/atan2_batch", [](bench::State& state)
+        {
+            TrigInputs in = MakeInputs();
+            state.SetItems(count);
+            state.Measure([&]()
+            {
+                fasttrig::Atan2Batch(in.ys.data(), in.xs.data(), in.first.data(), count);
+                bench::KeepAlive(in.first[count / 2]);
+            });
+
+            double maxError = 0.0;
+            for (std::size_t i = 0; i < count; ++i)
+            {
+                maxError = std::max(maxError, std::abs(in.first[i] - std::atan2(double(in.ys[i]), double(in.xs[i]))));
+            }
+            state.SetCounter("max_error", maxError, 2e-6);
+        });
+    }
+}
+
+BENCH_REGISTER(RegisterTrigCases);
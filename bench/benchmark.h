@@ -0,0 +1,131 @@
+//---------------------Minimal benchmark harness shared by every bench case---------------------------
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <functional>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace bench
+{
+    using Clock = std::chrono::steady_clock;
+
+    // Handed to every case. ns/op and throughput are per item, items is whatever one body call handles.
+    class State
+    {
+    public:
+        explicit State(double minSeconds) : minSeconds(minSeconds) {}
+
+        void SetItems(double itemsPerCall) { items = itemsPerCall; }
+        void SetCounter(const std::string& name, double value) { counters.emplace_back(name, value); }
+        void Skip(const std::string& reason) { skipped = true; skipReason = reason; }
+        // Fails the case, and with it the suite's exit status, whatever its timing
+        void Fail(const std::string& reason) { failures.push_back(reason); }
+
+        // Counter with an upper bound, a value above it or NaN fails the case
+        void SetCounter(const std::string& name, double value, double limit)
+        {
+            SetCounter(name, value);
+            if (!(value <= limit))
+            {
+                std::ostringstream reason;
+                reason << name << " " << value << " above " << limit;
+                Fail(reason.str());
+            }
+        }
+
+        // Calibrates a call count that fills minSeconds / sampleCount, then keeps the median sample
+        template <typename Fn>
+        void Measure(Fn&& body)
+        {
+            const int sampleCount = 5;
+            body();
+
+            std::size_t calls = 1;
+            double sampleSeconds = minSeconds / sampleCount;
+            for (;;)
+            {
+                double elapsed = Time(body, calls);
+                if (elapsed >= sampleSeconds || calls >= (std::size_t(1) << 30))
+                    break;
+                calls = elapsed <= 0.0 ? calls * 10 : std::max(calls + 1, std::size_t(calls * sampleSeconds / elapsed * 1.2));
+            }
+
+            std::vector<double> samples(sampleCount);
+            for (double& sample : samples)
+            {
+                sample = Time(body, calls) / calls;
+            }
+            std::sort(samples.begin(), samples.end());
+            Report(samples[sampleCount / 2]);
+        }
+
+        // For cases that pace themselves and time only part of each call instead of using Measure
+        void Report(double secondsPerCall)
+        {
+            nsPerOp = secondsPerCall * 1e9 / items;
+            itemsPerSecond = items / secondsPerCall;
+            measured = true;
+        }
+
+        double nsPerOp = 0.0;
+        double itemsPerSecond = 0.0;
+        bool measured = false;
+        bool skipped = false;
+        std::string skipReason;
+        std::vector<std::pair<std::string, double>> counters;
+        std::vector<std::string> failures;
+
+    private:
+        template <typename Fn>
+        static double Time(Fn& body, std::size_t calls)
+        {
+            Clock::time_point start = Clock::now();
+            for (std::size_t i = 0; i < calls; ++i)
+            {
+                body();
+            }
+            return std::chrono::duration<double>(Clock::now() - start).count();
+        }
+
+        double minSeconds;
+        double items = 1.0;
+    };
+
+    struct Case
+    {
+        std::string name;
+        std::function<void(State&)> run;
+    };
+
+    inline std::vector<Case>& Registry()
+    {
+        static std::vector<Case> cases;
+        return cases;
+    }
+
+    inline void Register(const std::string& name, std::function<void(State&)> run)
+    {
+        Registry().push_back({ name, std::move(run) });
+    }
+
+    // Stops the optimizer from deleting work whose result is otherwise unused
+    template <typename T>
+    inline void KeepAlive(const T& value)
+    {
+        static volatile T sink;
+        sink = value;
+        (void)sink;
+    }
+
+    struct Registrar
+    {
+        explicit Registrar(void (*registerCases)()) { registerCases(); }
+    };
+}
+
+// One per bench file: BENCH_REGISTER(RegisterOcclusionCases) runs the function at static init
+#define BENCH_REGISTER(fn) static bench::Registrar fn##Registrar(fn)
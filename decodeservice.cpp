@@ -0,0 +1,302 @@
+//---------------------Background decode service for compressed streams---------------------------
+#include "decodeservice.h"
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+
+namespace
+{
+    // Source frames per decode step, small enough that one stream cannot starve the others
+    const std::size_t chunkFrames = 4096;
+    const std::chrono::milliseconds idleSleep(1);
+}
+
+DecodeService::DecodeService(int samplingRate, int workerCount, int maxStreams) :
+    samplingRate(samplingRate),
+    running(true)
+{
+    for (int i = 0; i < maxStreams; ++i)
+    {
+        streams.push_back(std::make_unique<Stream>());
+    }
+    for (int i = 0; i < std::max(1, workerCount); ++i)
+    {
+        workers.emplace_back(&DecodeService::WorkerLoop, this);
+    }
+}
+
+DecodeService::~DecodeService()
+{
+    running.store(false, std::memory_order_release);
+    for (std::thread& worker : workers)
+    {
+        worker.join();
+    }
+    for (std::size_t i = 0; i < streams.size(); ++i)
+    {
+        CloseStream(static_cast<int>(i));
+    }
+}
+
+int DecodeService::OpenStream(const std::string& path, float prefetchSeconds, bool loop)
+{
+    auto slot = std::find_if(streams.begin(), streams.end(), [](const std::unique_ptr<Stream>& stream)
+    {
+        return stream->state.load(std::memory_order_acquire) == StreamFree;
+    });
+    if (slot == streams.end())
+    {
+        std::cerr << "Decode service has no free stream for: " << path << std::endl;
+        return -1;
+    }
+
+    Stream& stream = **slot;
+    std::unique_ptr<sf::InputSoundFile> file = std::make_unique<sf::InputSoundFile>();
+    if (!file->openFromFile(path) || file->getSampleCount() == 0)
+    {
+        std::cerr << "Failed to open audio stream: " << path << std::endl;
+        return -1;
+    }
+    stream.file = std::move(file);
+
+    stream.path = path;
+    stream.channels = stream.file->getChannelCount();
+    stream.loop = loop;
+    stream.resampler = std::make_unique<PolyphaseResampler>(stream.file->getSampleRate(), samplingRate);
+    // One chunk of output on top of the prefetch window, so a short prefetch still has room for
+    // the whole-chunk decode below. The slack covers the resampler rounding up.
+    stream.chunkOutput = chunkFrames * samplingRate / stream.file->getSampleRate() + 64;
+    std::size_t prefetchSamples = static_cast<std::size_t>(std::max(0.05f, prefetchSeconds) * samplingRate);
+    stream.ring = std::make_unique<SpscRing<float>>(prefetchSamples + stream.chunkOutput);
+    stream.interleaved.resize(chunkFrames * stream.channels);
+    stream.mono.resize(chunkFrames);
+    stream.pending.clear();
+    stream.pending.reserve(stream.chunkOutput);
+    stream.pendingOffset = 0;
+    stream.seekTarget.store(-1);
+    stream.seekInFlight.store(false);
+    stream.flushPending.store(false);
+    stream.finished.store(false);
+    stream.underruns.store(0);
+    stream.underrunSamples.store(0);
+    stream.decodedSamples.store(0);
+
+    // Prime the whole prefetch window here so playback never starts on an empty ring
+    while (DecodeChunk(stream))
+    {
+    }
+
+    stream.state.store(StreamActive, std::memory_order_release);
+    return static_cast<int>(slot - streams.begin());
+}
+
+void DecodeService::CloseStream(int streamId)
+{
+    Stream* stream = GetStream(streamId);
+    if (!stream || stream->state.load(std::memory_order_acquire) != StreamActive)
+        return;
+
+    // Wait out a worker that is mid chunk, then nobody else can touch the file
+    stream->state.store(StreamClosing, std::memory_order_release);
+    while (stream->busy.test_and_set(std::memory_order_acquire))
+    {
+        std::this_thread::yield();
+    }
+    stream->file.reset();
+    stream->resampler.reset();
+    stream->ring.reset();
+    stream->busy.clear(std::memory_order_release);
+    stream->state.store(StreamFree, std::memory_order_release);
+}
+
+void DecodeService::Seek(int streamId, float seconds)
+{
+    Stream* stream = GetStream(streamId);
+    if (!stream || stream->state.load(std::memory_order_acquire) != StreamActive)
+        return;
+    stream->seekTarget.store(static_cast<std::int64_t>(std::max(0.f, seconds) * 1e6f), std::memory_order_release);
+}
+
+std::size_t DecodeService::Read(int streamId, float* output, std::size_t count)
+{
+    Stream* stream = GetStream(streamId);
+    if (!stream || stream->state.load(std::memory_order_acquire) != StreamActive)
+    {
+        std::fill(output, output + count, 0.f);
+        return 0;
+    }
+
+    // The worker stopped writing when it seeked, everything still queued is from before the seek
+    if (stream->flushPending.load(std::memory_order_acquire))
+    {
+        stream->ring->Clear();
+        stream->flushPending.store(false, std::memory_order_release);
+        std::fill(output, output + count, 0.f);
+        return 0;
+    }
+
+    std::size_t read = stream->ring->Read(output, count);
+    std::fill(output + read, output + count, 0.f);
+
+    // Running dry at the end of a file or while a seek is in flight is expected, anything else is an underrun
+    bool expected = stream->finished.load(std::memory_order_acquire) || stream->seekTarget.load(std::memory_order_acquire) >= 0 ||
+                    stream->seekInFlight.load(std::memory_order_acquire);
+    if (read < count && !expected)
+    {
+        stream->underruns.fetch_add(1, std::memory_order_relaxed);
+        stream->underrunSamples.fetch_add(count - read, std::memory_order_relaxed);
+    }
+    return read;
+}
+
+bool DecodeService::IsFinished(int streamId) const
+{
+    Stream* stream = GetStream(streamId);
+    if (!stream || stream->state.load(std::memory_order_acquire) != StreamActive)
+        return true;
+    return stream->finished.load(std::memory_order_acquire) && stream->ring->Size() == 0;
+}
+
+DecodeStreamStats DecodeService::GetStats(int streamId) const
+{
+    DecodeStreamStats stats;
+    Stream* stream = GetStream(streamId);
+    if (!stream || stream->state.load(std::memory_order_acquire) != StreamActive)
+        return stats;
+
+    stats.underruns = stream->underruns.load(std::memory_order_relaxed);
+    stats.underrunSamples = stream->underrunSamples.load(std::memory_order_relaxed);
+    stats.decodedSamples = stream->decodedSamples.load(std::memory_order_relaxed);
+    stats.buffered = stream->ring->Size();
+    stats.capacity = stream->ring->Capacity();
+    return stats;
+}
+
+void DecodeService::ReportUnderruns(std::ostream& out) const
+{
+    for (std::size_t i = 0; i < streams.size(); ++i)
+    {
+        if (streams[i]->state.load(std::memory_order_acquire) != StreamActive)
+            continue;
+
+        DecodeStreamStats stats = GetStats(static_cast<int>(i));
+        out << "Stream " << streams[i]->path << ": " << stats.underruns << " underruns, "
+            << 1000.0 * stats.underrunSamples / samplingRate << " ms of silence, "
+            << stats.decodedSamples << " samples decoded" << std::endl;
+    }
+}
+
+void DecodeService::WorkerLoop()
+{
+    while (running.load(std::memory_order_acquire))
+    {
+        // Serve the emptiest ring first, a stream about to underrun beats one that is nearly full.
+        // A stream is claimed before its ring is looked at, Close may be tearing it down.
+        Stream* neediest = nullptr;
+        float lowestFill = 1.f;
+        for (const std::unique_ptr<Stream>& stream : streams)
+        {
+            if (stream->state.load(std::memory_order_acquire) != StreamActive || stream->busy.test_and_set(std::memory_order_acquire))
+                continue;
+
+            if (stream->state.load(std::memory_order_acquire) == StreamActive)
+            {
+                float fill = float(stream->ring->Size()) / stream->ring->Capacity();
+                bool wantsSeek = stream->seekTarget.load(std::memory_order_acquire) >= 0;
+                if (wantsSeek)
+                    fill = -1.f;
+                if (fill < lowestFill && (wantsSeek || !stream->finished.load(std::memory_order_acquire)))
+                {
+                    lowestFill = fill;
+                    neediest = stream.get();
+                }
+            }
+            stream->busy.clear(std::memory_order_release);
+        }
+
+        bool worked = false;
+        if (neediest && !neediest->busy.test_and_set(std::memory_order_acquire))
+        {
+            if (neediest->state.load(std::memory_order_acquire) == StreamActive)
+                worked = DecodeChunk(*neediest);
+            neediest->busy.clear(std::memory_order_release);
+        }
+
+        if (!worked)
+            std::this_thread::sleep_for(idleSleep);
+    }
+}
+
+bool DecodeService::DecodeChunk(Stream& stream)
+{
+    if (stream.flushPending.load(std::memory_order_acquire))
+        return false;
+
+    // Only Seek stores a target and only this thread clears one, so the exchange takes the newest
+    if (stream.seekTarget.load(std::memory_order_acquire) >= 0)
+    {
+        stream.seekInFlight.store(true, std::memory_order_release);
+        std::int64_t seekTarget = stream.seekTarget.exchange(-1, std::memory_order_acq_rel);
+        stream.file->seek(sf::microseconds(seekTarget));
+        stream.resampler->Reset();
+        stream.pending.clear();
+        stream.pendingOffset = 0;
+        stream.finished.store(false, std::memory_order_release);
+        stream.flushPending.store(true, std::memory_order_release);
+        stream.seekInFlight.store(false, std::memory_order_release);
+        return true;
+    }
+
+    // Leftovers from the previous chunk go first
+    if (stream.pendingOffset < stream.pending.size())
+    {
+        std::size_t written = stream.ring->Write(stream.pending.data() + stream.pendingOffset, stream.pending.size() - stream.pendingOffset);
+        stream.pendingOffset += written;
+        return written > 0;
+    }
+
+    if (stream.finished.load(std::memory_order_acquire))
+        return false;
+
+    // Only decode once a whole chunk worth of space is free, the ring always holds one
+    if (stream.ring->Free() < stream.chunkOutput)
+        return false;
+
+    std::size_t read = static_cast<std::size_t>(stream.file->read(stream.interleaved.data(), stream.interleaved.size()));
+    std::size_t frames = read / stream.channels;
+    if (frames == 0)
+    {
+        if (stream.loop)
+        {
+            stream.file->seek(sf::Time::Zero);
+            return true;
+        }
+        stream.finished.store(true, std::memory_order_release);
+        return false;
+    }
+
+    float scale = 1.f / (32767.f * stream.channels);
+    for (std::size_t frame = 0; frame < frames; ++frame)
+    {
+        float sum = 0.f;
+        for (unsigned int channel = 0; channel < stream.channels; ++channel)
+        {
+            sum += stream.interleaved[frame * stream.channels + channel];
+        }
+        stream.mono[frame] = sum * scale;
+    }
+
+    stream.pending.clear();
+    stream.pendingOffset = 0;
+    stream.resampler->Process(stream.mono.data(), frames, stream.pending);
+    stream.pendingOffset = stream.ring->Write(stream.pending.data(), stream.pending.size());
+    stream.decodedSamples.fetch_add(stream.pending.size(), std::memory_order_relaxed);
+    return true;
+}
+
+DecodeService::Stream* DecodeService::GetStream(int streamId) const
+{
+    if (streamId < 0 || streamId >= static_cast<int>(streams.size()))
+        return nullptr;
+    return streams[streamId].get();
+}
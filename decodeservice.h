@@ -0,0 +1,106 @@
+//---------------------Background decode service for compressed streams---------------------------
+#pragma once
+
+#include "resampler.h"
+#include "ringbuffer.h"
+#include <SFML/Audio.hpp>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <ostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+struct DecodeStreamStats
+{
+    unsigned underruns = 0;
+    std::uint64_t underrunSamples = 0;
+    std::uint64_t decodedSamples = 0;
+    std::size_t buffered = 0;
+    std::size_t capacity = 0;
+};
+
+// Worker threads decode Ogg/FLAC/WAV through sf::InputSoundFile into one lock free ring per
+// stream, mono at the engine rate. The audio thread only ever reads a ring: when decode falls
+// behind it gets silence and an underrun is counted, it never waits on disk or a decoder.
+// Open, Close and Seek belong to the control (main) thread, Read to a single audio thread.
+class DecodeService
+{
+public:
+    DecodeService(int samplingRate, int workerCount = 2, int maxStreams = 16);
+    ~DecodeService();
+
+    DecodeService(const DecodeService&) = delete;
+    DecodeService& operator=(const DecodeService&) = delete;
+
+    // prefetchSeconds sizes the ring, it is filled before this returns. Returns -1 on failure.
+    int OpenStream(const std::string& path, float prefetchSeconds = 0.5f, bool loop = false);
+    // The audio thread must no longer read the stream
+    void CloseStream(int streamId);
+
+    // Handled by a worker, queued audio is dropped and Read returns silence until new data arrives
+    void Seek(int streamId, float seconds);
+
+    // Audio thread, always writes count samples and returns how many were real audio
+    std::size_t Read(int streamId, float* output, std::size_t count);
+
+    // A non-looping stream that has played out
+    bool IsFinished(int streamId) const;
+
+    DecodeStreamStats GetStats(int streamId) const;
+    void ReportUnderruns(std::ostream& out) const;
+
+private:
+    enum StreamState
+    {
+        StreamFree,
+        StreamActive,
+        StreamClosing
+    };
+
+    struct Stream
+    {
+        std::atomic<int> state{ StreamFree };
+        // Held by whichever worker is decoding, so two never touch the same file
+        std::atomic_flag busy = ATOMIC_FLAG_INIT;
+
+        std::string path;
+        std::unique_ptr<sf::InputSoundFile> file;
+        unsigned int channels = 1;
+        bool loop = false;
+        std::unique_ptr<PolyphaseResampler> resampler;
+        std::unique_ptr<SpscRing<float>> ring;
+        // Ring samples one decoded chunk can produce
+        std::size_t chunkOutput = 0;
+
+        // Worker scratch, sized at open so decode never allocates
+        std::vector<sf::Int16> interleaved;
+        std::vector<float> mono;
+        std::vector<float> pending;
+        std::size_t pendingOffset = 0;
+
+        // Seek target in microseconds, -1 when none. The worker takes it with an exchange, so a
+        // newer target stored meanwhile is kept for the next chunk. seekInFlight covers the gap
+        // between taking it and raising flushPending. While flushPending is set the worker
+        // writes nothing and the audio thread drops whatever is left in the ring.
+        std::atomic<std::int64_t> seekTarget{ -1 };
+        std::atomic<bool> seekInFlight{ false };
+        std::atomic<bool> flushPending{ false };
+        std::atomic<bool> finished{ false };
+
+        std::atomic<unsigned> underruns{ 0 };
+        std::atomic<std::uint64_t> underrunSamples{ 0 };
+        std::atomic<std::uint64_t> decodedSamples{ 0 };
+    };
+
+    void WorkerLoop();
+    // Returns false when the stream had nothing to do
+    bool DecodeChunk(Stream& stream);
+    Stream* GetStream(int streamId) const;
+
+    int samplingRate;
+    std::vector<std::unique_ptr<Stream>> streams;
+    std::vector<std::thread> workers;
+    std::atomic<bool> running;
+};
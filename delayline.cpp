@@ -0,0 +1,244 @@
+//---------------------Variable delay lines for propagation delay and Doppler---------------------------
+#include "delayline.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#define DELAYLINE_LANES 8
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define DELAYLINE_SSE2 1
+#define DELAYLINE_LANES 4
+#else
+#define DELAYLINE_LANES 1
+#endif
+
+namespace
+{
+    const float speedOfSound = 343.f;
+
+    // Largest delay change per sample, the pitch ratio stays within [1 - maxSlew, 1 + maxSlew]
+    const float maxSlew = 0.5f;
+
+    // The interpolator reads one sample past the integer delay, so a delay of one sample is the shortest
+    const float minDelay = 1.f;
+
+    std::uint32_t NextPowerOfTwo(std::uint32_t value)
+    {
+        std::uint32_t result = 1;
+        while (result < value)
+        {
+            result <<= 1;
+        }
+        return result;
+    }
+
+    // Lagrange weights for taps at -1, 0, 1, 2 evaluated at f in [0, 1]
+    inline void LagrangeWeights(float f, float& w0, float& w1, float& w2, float& w3)
+    {
+        float fp1 = f + 1.f;
+        float fm1 = f - 1.f;
+        float fm2 = f - 2.f;
+        w0 = -f * fm1 * fm2 * (1.f / 6.f);
+        w1 = fp1 * fm1 * fm2 * 0.5f;
+        w2 = -fp1 * f * fm2 * 0.5f;
+        w3 = fp1 * f * fm1 * (1.f / 6.f);
+    }
+}
+
+DelayLineBank::DelayLineBank(int voiceCount, int samplingRate, int maxFrameSize, float maxDelaySeconds) :
+    voiceCount(voiceCount),
+    laneCount((voiceCount + DELAYLINE_LANES - 1) / DELAYLINE_LANES * DELAYLINE_LANES),
+    maxFrameSize(maxFrameSize),
+    samplingRate(static_cast<float>(samplingRate)),
+    maxDelay(std::max(minDelay, maxDelaySeconds * samplingRate)),
+    writePos(0)
+{
+    // Room for the longest delay, the block being written and the interpolator's taps
+    ringSize = NextPowerOfTwo(static_cast<std::uint32_t>(std::ceil(maxDelay)) + maxFrameSize + 4);
+    mask = ringSize - 1;
+
+    // Padding lanes keep their own silent ring so every SIMD group reads valid memory
+    rings.assign(std::size_t(laneCount) * ringSize, 0.f);
+    currentDelay.assign(laneCount, minDelay);
+    targetDelay.assign(laneCount, minDelay);
+    delayStep.assign(laneCount, 0.f);
+    staged.assign(std::size_t(maxFrameSize) * laneCount, 0.f);
+}
+
+float DelayLineBank::DistanceToDelay(float meters) const
+{
+    return std::max(minDelay, std::min(maxDelay, meters / speedOfSound * samplingRate));
+}
+
+void DelayLineBank::ResetVoice(int voice, float delaySamples)
+{
+    std::fill(rings.begin() + std::size_t(voice) * ringSize, rings.begin() + std::size_t(voice + 1) * ringSize, 0.f);
+    currentDelay[voice] = std::max(minDelay, std::min(maxDelay, delaySamples));
+    targetDelay[voice] = currentDelay[voice];
+}
+
+void DelayLineBank::SetTargetDelay(int voice, float delaySamples)
+{
+    targetDelay[voice] = std::max(minDelay, std::min(maxDelay, delaySamples));
+}
+
+void DelayLineBank::Process(const float* const* inputs, float* const* outputs, int frameCount)
+{
+    frameCount = std::min(frameCount, maxFrameSize);
+
+    // The block goes into the rings first, short delays read samples from it
+    std::uint32_t firstPart = std::min<std::uint32_t>(frameCount, ringSize - writePos);
+    for (int v = 0; v < voiceCount; ++v)
+    {
+        float* ring = &rings[std::size_t(v) * ringSize];
+        if (inputs[v])
+        {
+            std::memcpy(ring + writePos, inputs[v], firstPart * sizeof(float));
+            std::memcpy(ring, inputs[v] + firstPart, (frameCount - firstPart) * sizeof(float));
+        }
+        else
+        {
+            std::fill(ring + writePos, ring + writePos + firstPart, 0.f);
+            std::fill(ring, ring + (frameCount - firstPart), 0.f);
+        }
+    }
+
+    float maxChange = maxSlew * frameCount;
+    for (int v = 0; v < laneCount; ++v)
+    {
+        float target = std::max(currentDelay[v] - maxChange, std::min(currentDelay[v] + maxChange, targetDelay[v]));
+        delayStep[v] = (target - currentDelay[v]) / frameCount;
+    }
+
+    for (int lane = 0; lane < laneCount; lane += DELAYLINE_LANES)
+    {
+        ProcessLanes(lane, frameCount);
+    }
+
+    for (int v = 0; v < laneCount; ++v)
+    {
+        currentDelay[v] += delayStep[v] * frameCount;
+    }
+    for (int v = 0; v < voiceCount; ++v)
+    {
+        float* out = outputs[v];
+        for (int i = 0; i < frameCount; ++i)
+        {
+            out[i] = staged[std::size_t(i) * laneCount + v];
+        }
+    }
+    writePos = (writePos + frameCount) & mask;
+}
+
+// Sample i of a lane is read at (writePos + i) - delay. With delay = whole + frac the four taps
+// start at writePos + i - whole - 2 and the interpolation point sits 1 - frac past the second.
+void DelayLineBank::ProcessLanes(int firstLane, int frameCount)
+{
+    const float* base = rings.data();
+    float* out = staged.data() + firstLane;
+
+#if defined(__AVX2__)
+    const __m256 one = _mm256_set1_ps(1.f);
+    const __m256 two = _mm256_set1_ps(2.f);
+    const __m256 half = _mm256_set1_ps(0.5f);
+    const __m256 sixth = _mm256_set1_ps(1.f / 6.f);
+    const __m256i maskVec = _mm256_set1_epi32(static_cast<int>(mask));
+    const __m256i ringOffsets = _mm256_mullo_epi32(_mm256_add_epi32(_mm256_set1_epi32(firstLane), _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7)),
+                                                   _mm256_set1_epi32(static_cast<int>(ringSize)));
+    __m256 delay = _mm256_loadu_ps(&currentDelay[firstLane]);
+    const __m256 step = _mm256_loadu_ps(&delayStep[firstLane]);
+
+    for (int i = 0; i < frameCount; ++i)
+    {
+        delay = _mm256_add_ps(delay, step);
+        __m256i whole = _mm256_cvttps_epi32(delay);
+        __m256 f = _mm256_sub_ps(one, _mm256_sub_ps(delay, _mm256_cvtepi32_ps(whole)));
+        __m256i first = _mm256_sub_epi32(_mm256_set1_epi32(static_cast<int>(writePos) + i - 2), whole);
+
+        __m256 taps[4];
+        for (int k = 0; k < 4; ++k)
+        {
+            __m256i index = _mm256_add_epi32(_mm256_and_si256(_mm256_add_epi32(first, _mm256_set1_epi32(k)), maskVec), ringOffsets);
+            taps[k] = _mm256_i32gather_ps(base, index, 4);
+        }
+
+        __m256 fp1 = _mm256_add_ps(f, one);
+        __m256 fm1 = _mm256_sub_ps(f, one);
+        __m256 fm2 = _mm256_sub_ps(f, two);
+        __m256 ffm1 = _mm256_mul_ps(f, fm1);
+        __m256 fp1fm2 = _mm256_mul_ps(fp1, fm2);
+        __m256 w0 = _mm256_mul_ps(_mm256_mul_ps(ffm1, fm2), sixth);
+        __m256 w1 = _mm256_mul_ps(_mm256_mul_ps(fp1fm2, fm1), half);
+        __m256 w2 = _mm256_mul_ps(_mm256_mul_ps(fp1fm2, f), half);
+        __m256 w3 = _mm256_mul_ps(_mm256_mul_ps(ffm1, fp1), sixth);
+
+        // w0 and w2 carry a minus sign, folded into the subtractions
+        __m256 sum = _mm256_sub_ps(_mm256_mul_ps(w1, taps[1]), _mm256_mul_ps(w0, taps[0]));
+        sum = _mm256_sub_ps(sum, _mm256_mul_ps(w2, taps[2]));
+        sum = _mm256_add_ps(sum, _mm256_mul_ps(w3, taps[3]));
+        _mm256_storeu_ps(out + std::size_t(i) * laneCount, sum);
+    }
+#elif defined(DELAYLINE_SSE2)
+    const __m128 one = _mm_set1_ps(1.f);
+    const __m128 two = _mm_set1_ps(2.f);
+    const __m128 half = _mm_set1_ps(0.5f);
+    const __m128 sixth = _mm_set1_ps(1.f / 6.f);
+    const std::size_t ringOffsets[4] = {
+        std::size_t(firstLane) * ringSize, std::size_t(firstLane + 1) * ringSize,
+        std::size_t(firstLane + 2) * ringSize, std::size_t(firstLane + 3) * ringSize };
+    __m128 delay = _mm_loadu_ps(&currentDelay[firstLane]);
+    const __m128 step = _mm_loadu_ps(&delayStep[firstLane]);
+
+    for (int i = 0; i < frameCount; ++i)
+    {
+        delay = _mm_add_ps(delay, step);
+        __m128i whole = _mm_cvttps_epi32(delay);
+        __m128 f = _mm_sub_ps(one, _mm_sub_ps(delay, _mm_cvtepi32_ps(whole)));
+        __m128i first = _mm_sub_epi32(_mm_set1_epi32(static_cast<int>(writePos) + i - 2), whole);
+
+        // SSE2 has no gather, the tap loads are scalar and the arithmetic stays vectorized
+        alignas(16) std::int32_t firstTap[4];
+        _mm_store_si128(reinterpret_cast<__m128i*>(firstTap), first);
+        __m128 taps[4];
+        for (int k = 0; k < 4; ++k)
+        {
+            taps[k] = _mm_setr_ps(base[ringOffsets[0] + ((firstTap[0] + k) & mask)], base[ringOffsets[1] + ((firstTap[1] + k) & mask)],
+                                  base[ringOffsets[2] + ((firstTap[2] + k) & mask)], base[ringOffsets[3] + ((firstTap[3] + k) & mask)]);
+        }
+
+        __m128 fp1 = _mm_add_ps(f, one);
+        __m128 fm1 = _mm_sub_ps(f, one);
+        __m128 fm2 = _mm_sub_ps(f, two);
+        __m128 ffm1 = _mm_mul_ps(f, fm1);
+        __m128 fp1fm2 = _mm_mul_ps(fp1, fm2);
+        __m128 w0 = _mm_mul_ps(_mm_mul_ps(ffm1, fm2), sixth);
+        __m128 w1 = _mm_mul_ps(_mm_mul_ps(fp1fm2, fm1), half);
+        __m128 w2 = _mm_mul_ps(_mm_mul_ps(fp1fm2, f), half);
+        __m128 w3 = _mm_mul_ps(_mm_mul_ps(ffm1, fp1), sixth);
+
+        // w0 and w2 carry a minus sign, folded into the subtractions
+        __m128 sum = _mm_sub_ps(_mm_mul_ps(w1, taps[1]), _mm_mul_ps(w0, taps[0]));
+        sum = _mm_sub_ps(sum, _mm_mul_ps(w2, taps[2]));
+        sum = _mm_add_ps(sum, _mm_mul_ps(w3, taps[3]));
+        _mm_storeu_ps(out + std::size_t(i) * laneCount, sum);
+    }
+#else
+    const float* ring = base + std::size_t(firstLane) * ringSize;
+    float delay = currentDelay[firstLane];
+    for (int i = 0; i < frameCount; ++i)
+    {
+        delay += delayStep[firstLane];
+        std::int32_t whole = static_cast<std::int32_t>(delay);
+        float f = 1.f - (delay - whole);
+        std::int32_t first = static_cast<std::int32_t>(writePos) + i - 2 - whole;
+
+        float w0, w1, w2, w3;
+        LagrangeWeights(f, w0, w1, w2, w3);
+        out[std::size_t(i) * laneCount] = w0 * ring[first & mask] + w1 * ring[(first + 1) & mask]
+                                        + w2 * ring[(first + 2) & mask] + w3 * ring[(first + 3) & mask];
+    }
+#endif
+}
@@ -0,0 +1,56 @@
+//---------------------Variable delay lines for propagation delay and Doppler---------------------------
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+// One delay line per voice, processed together so the interpolation runs across voices in
+// SIMD lanes (8 with AVX2, 4 with SSE2). Each block the delay of a voice ramps linearly to
+// its target, a shrinking delay raises the pitch and a growing one lowers it, which is the
+// Doppler shift of a source moving relative to the listener. Reads use 4 point Lagrange
+// interpolation, at 48 kHz the error is about -94 dB at 1 kHz and -48 dB at 5 kHz.
+class DelayLineBank
+{
+public:
+    // maxFrameSize bounds Process' frameCount, maxDelaySeconds bounds every delay
+    DelayLineBank(int voiceCount, int samplingRate, int maxFrameSize, float maxDelaySeconds = 0.5f);
+
+    int GetVoiceCount() const { return voiceCount; }
+    float GetMaxDelay() const { return maxDelay; }
+
+    // Propagation delay in samples for a source this many metres away
+    float DistanceToDelay(float meters) const;
+
+    // Clears the voice's history and sets its delay without a ramp, for a voice that starts a new sound
+    void ResetVoice(int voice, float delaySamples);
+
+    // Delay reached at the end of the next block, the change is spread linearly over it.
+    // The ramp is limited to +-50% pitch so a teleporting source does not produce a squeal.
+    void SetTargetDelay(int voice, float delaySamples);
+    float GetDelay(int voice) const { return currentDelay[voice]; }
+
+    // inputs[v] and outputs[v] hold frameCount samples, a null input is silence
+    void Process(const float* const* inputs, float* const* outputs, int frameCount);
+
+private:
+    void ProcessLanes(int firstLane, int frameCount);
+
+    int voiceCount;
+    int laneCount;
+    int maxFrameSize;
+    float samplingRate;
+    float maxDelay;
+
+    // Planar, voice v owns rings[v * ringSize .. (v + 1) * ringSize)
+    std::uint32_t ringSize;
+    std::uint32_t mask;
+    std::uint32_t writePos;
+    std::vector<float> rings;
+
+    std::vector<float> currentDelay;
+    std::vector<float> targetDelay;
+    std::vector<float> delayStep;
+
+    // Lane interleaved output, frame i of lane v at staged[i * laneCount + v]
+    std::vector<float> staged;
+};
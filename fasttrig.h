@@ -0,0 +1,294 @@
+//---------------------Polynomial sin/cos/atan2 approximations, scalar and SIMD batch---------------------------
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#endif
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define FASTTRIG_SSE2 1
+#endif
+
+// Error bounds, measured against libm by bench/bench_trig:
+//   SinCos: absolute error <= 1e-7 for |x| <= 8192 rad, accuracy degrades linearly beyond
+//   Atan2:  absolute error <= 2e-6 rad (about 1e-4 degrees), Atan2(0, 0) returns 0
+// Batch forms evaluate the same polynomials and stay within the same bounds.
+namespace fasttrig
+{
+    namespace detail
+    {
+        // pi/2 split in three parts (Cody-Waite) so the range reduction stays exact
+        const float piOver2Hi = 1.5703125f;
+        const float piOver2Mid = 4.837512969970703125e-4f;
+        const float piOver2Lo = 7.54978995489188216e-8f;
+        const float twoOverPi = 0.636619772367581343f;
+
+        // Minimax coefficients on [-pi/4, pi/4] (Cephes)
+        const float sin1 = -1.6666654611e-1f;
+        const float sin2 = 8.3321608736e-3f;
+        const float sin3 = -1.9515295891e-4f;
+        const float cos1 = 4.166664568298827e-2f;
+        const float cos2 = -1.388731625493765e-3f;
+        const float cos3 = 2.443315711809948e-5f;
+
+        // atan on [0, 1]
+        const float atan1 = 0.99997726f;
+        const float atan2c = -0.33262347f;
+        const float atan3 = 0.19354346f;
+        const float atan4 = -0.11643287f;
+        const float atan5 = 0.05265332f;
+        const float atan6 = -0.01172120f;
+
+        const float piVal = 3.14159265358979323846f;
+        const float halfPi = 1.57079632679489661923f;
+
+        inline std::uint32_t FloatBits(float value)
+        {
+            std::uint32_t bits;
+            std::memcpy(&bits, &value, sizeof(bits));
+            return bits;
+        }
+
+        inline float BitsFloat(std::uint32_t bits)
+        {
+            float value;
+            std::memcpy(&value, &bits, sizeof(value));
+            return value;
+        }
+
+        inline std::int32_t RoundToInt(float value)
+        {
+#ifdef FASTTRIG_SSE2
+            // Same rounding mode as the SIMD path
+            return _mm_cvtss_si32(_mm_set_ss(value));
+#else
+            return static_cast<std::int32_t>(value >= 0.f ? value + 0.5f : value - 0.5f);
+#endif
+        }
+    }
+
+    inline void SinCos(float x, float& sinOut, float& cosOut)
+    {
+        using namespace detail;
+
+        std::int32_t quadrant = RoundToInt(x * twoOverPi);
+        float k = static_cast<float>(quadrant);
+        float r = ((x - k * piOver2Hi) - k * piOver2Mid) - k * piOver2Lo;
+        float z = r * r;
+
+        float s = r + r * z * (sin1 + z * (sin2 + z * sin3));
+        float c = 1.f - 0.5f * z + z * z * (cos1 + z * (cos2 + z * cos3));
+
+        // Quadrant 1 and 3 swap sin and cos, the sign bits follow the quadrant
+        bool swap = (quadrant & 1) != 0;
+        float sinValue = swap ? c : s;
+        float cosValue = swap ? s : c;
+        std::uint32_t sinSign = static_cast<std::uint32_t>(quadrant & 2) << 30;
+        std::uint32_t cosSign = static_cast<std::uint32_t>((quadrant + 1) & 2) << 30;
+        sinOut = BitsFloat(FloatBits(sinValue) ^ sinSign);
+        cosOut = BitsFloat(FloatBits(cosValue) ^ cosSign);
+    }
+
+    inline float Sin(float x)
+    {
+        float s, c;
+        SinCos(x, s, c);
+        return s;
+    }
+
+    inline float Cos(float x)
+    {
+        float s, c;
+        SinCos(x, s, c);
+        return c;
+    }
+
+    inline float Atan2(float y, float x)
+    {
+        using namespace detail;
+
+        float ax = x < 0.f ? -x : x;
+        float ay = y < 0.f ? -y : y;
+        float maxValue = ax > ay ? ax : ay;
+        float minValue = ax > ay ? ay : ax;
+        float a = maxValue > 0.f ? minValue / maxValue : 0.f;
+
+        float z = a * a;
+        float r = a * (atan1 + z * (atan2c + z * (atan3 + z * (atan4 + z * (atan5 + z * atan6)))));
+        r = ay > ax ? halfPi - r : r;
+        r = x < 0.f ? piVal - r : r;
+        return y < 0.f ? -r : r;
+    }
+
+    ///////////////////////////////////////
+    //
+    //	Batch forms, any count and alignment
+    //
+
+#if defined(__AVX2__)
+    namespace detail
+    {
+        inline void SinCos8(__m256 x, __m256& sinOut, __m256& cosOut)
+        {
+            __m256i quadrant = _mm256_cvtps_epi32(_mm256_mul_ps(x, _mm256_set1_ps(twoOverPi)));
+            __m256 k = _mm256_cvtepi32_ps(quadrant);
+            __m256 r = _mm256_sub_ps(x, _mm256_mul_ps(k, _mm256_set1_ps(piOver2Hi)));
+            r = _mm256_sub_ps(r, _mm256_mul_ps(k, _mm256_set1_ps(piOver2Mid)));
+            r = _mm256_sub_ps(r, _mm256_mul_ps(k, _mm256_set1_ps(piOver2Lo)));
+            __m256 z = _mm256_mul_ps(r, r);
+
+            __m256 ps = _mm256_add_ps(_mm256_set1_ps(sin2), _mm256_mul_ps(z, _mm256_set1_ps(sin3)));
+            ps = _mm256_add_ps(_mm256_set1_ps(sin1), _mm256_mul_ps(z, ps));
+            __m256 s = _mm256_add_ps(r, _mm256_mul_ps(_mm256_mul_ps(r, z), ps));
+
+            __m256 pc = _mm256_add_ps(_mm256_set1_ps(cos2), _mm256_mul_ps(z, _mm256_set1_ps(cos3)));
+            pc = _mm256_add_ps(_mm256_set1_ps(cos1), _mm256_mul_ps(z, pc));
+            __m256 c = _mm256_sub_ps(_mm256_set1_ps(1.f), _mm256_mul_ps(_mm256_set1_ps(0.5f), z));
+            c = _mm256_add_ps(c, _mm256_mul_ps(_mm256_mul_ps(z, z), pc));
+
+            __m256 swap = _mm256_castsi256_ps(_mm256_cmpeq_epi32(_mm256_and_si256(quadrant, _mm256_set1_epi32(1)), _mm256_set1_epi32(1)));
+            __m256 sinValue = _mm256_blendv_ps(s, c, swap);
+            __m256 cosValue = _mm256_blendv_ps(c, s, swap);
+            __m256 sinSign = _mm256_castsi256_ps(_mm256_slli_epi32(_mm256_and_si256(quadrant, _mm256_set1_epi32(2)), 30));
+            __m256 cosSign = _mm256_castsi256_ps(_mm256_slli_epi32(_mm256_and_si256(_mm256_add_epi32(quadrant, _mm256_set1_epi32(1)), _mm256_set1_epi32(2)), 30));
+            sinOut = _mm256_xor_ps(sinValue, sinSign);
+            cosOut = _mm256_xor_ps(cosValue, cosSign);
+        }
+
+        inline __m256 Atan2x8(__m256 y, __m256 x)
+        {
+            const __m256 signMask = _mm256_set1_ps(-0.f);
+            __m256 ax = _mm256_andnot_ps(signMask, x);
+            __m256 ay = _mm256_andnot_ps(signMask, y);
+            __m256 maxValue = _mm256_max_ps(ax, ay);
+            __m256 minValue = _mm256_min_ps(ax, ay);
+            __m256 nonZero = _mm256_cmp_ps(maxValue, _mm256_setzero_ps(), _CMP_GT_OQ);
+            __m256 a = _mm256_and_ps(_mm256_div_ps(minValue, maxValue), nonZero);
+
+            __m256 z = _mm256_mul_ps(a, a);
+            __m256 p = _mm256_add_ps(_mm256_set1_ps(atan5), _mm256_mul_ps(z, _mm256_set1_ps(atan6)));
+            p = _mm256_add_ps(_mm256_set1_ps(atan4), _mm256_mul_ps(z, p));
+            p = _mm256_add_ps(_mm256_set1_ps(atan3), _mm256_mul_ps(z, p));
+            p = _mm256_add_ps(_mm256_set1_ps(atan2c), _mm256_mul_ps(z, p));
+            p = _mm256_add_ps(_mm256_set1_ps(atan1), _mm256_mul_ps(z, p));
+            __m256 r = _mm256_mul_ps(a, p);
+
+            r = _mm256_blendv_ps(r, _mm256_sub_ps(_mm256_set1_ps(halfPi), r), _mm256_cmp_ps(ay, ax, _CMP_GT_OQ));
+            r = _mm256_blendv_ps(r, _mm256_sub_ps(_mm256_set1_ps(piVal), r), _mm256_cmp_ps(x, _mm256_setzero_ps(), _CMP_LT_OQ));
+            return _mm256_blendv_ps(r, _mm256_xor_ps(r, signMask), _mm256_cmp_ps(y, _mm256_setzero_ps(), _CMP_LT_OQ));
+        }
+    }
+#endif
+
+#ifdef FASTTRIG_SSE2
+    namespace detail
+    {
+        inline __m128 Select(__m128 mask, __m128 whenTrue, __m128 whenFalse)
+        {
+            return _mm_or_ps(_mm_and_ps(mask, whenTrue), _mm_andnot_ps(mask, whenFalse));
+        }
+
+        inline void SinCos4(__m128 x, __m128& sinOut, __m128& cosOut)
+        {
+            __m128i quadrant = _mm_cvtps_epi32(_mm_mul_ps(x, _mm_set1_ps(twoOverPi)));
+            __m128 k = _mm_cvtepi32_ps(quadrant);
+            __m128 r = _mm_sub_ps(x, _mm_mul_ps(k, _mm_set1_ps(piOver2Hi)));
+            r = _mm_sub_ps(r, _mm_mul_ps(k, _mm_set1_ps(piOver2Mid)));
+            r = _mm_sub_ps(r, _mm_mul_ps(k, _mm_set1_ps(piOver2Lo)));
+            __m128 z = _mm_mul_ps(r, r);
+
+            __m128 ps = _mm_add_ps(_mm_set1_ps(sin2), _mm_mul_ps(z, _mm_set1_ps(sin3)));
+            ps = _mm_add_ps(_mm_set1_ps(sin1), _mm_mul_ps(z, ps));
+            __m128 s = _mm_add_ps(r, _mm_mul_ps(_mm_mul_ps(r, z), ps));
+
+            __m128 pc = _mm_add_ps(_mm_set1_ps(cos2), _mm_mul_ps(z, _mm_set1_ps(cos3)));
+            pc = _mm_add_ps(_mm_set1_ps(cos1), _mm_mul_ps(z, pc));
+            __m128 c = _mm_sub_ps(_mm_set1_ps(1.f), _mm_mul_ps(_mm_set1_ps(0.5f), z));
+            c = _mm_add_ps(c, _mm_mul_ps(_mm_mul_ps(z, z), pc));
+
+            __m128 swap = _mm_castsi128_ps(_mm_cmpeq_epi32(_mm_and_si128(quadrant, _mm_set1_epi32(1)), _mm_set1_epi32(1)));
+            __m128 sinValue = Select(swap, c, s);
+            __m128 cosValue = Select(swap, s, c);
+            __m128 sinSign = _mm_castsi128_ps(_mm_slli_epi32(_mm_and_si128(quadrant, _mm_set1_epi32(2)), 30));
+            __m128 cosSign = _mm_castsi128_ps(_mm_slli_epi32(_mm_and_si128(_mm_add_epi32(quadrant, _mm_set1_epi32(1)), _mm_set1_epi32(2)), 30));
+            sinOut = _mm_xor_ps(sinValue, sinSign);
+            cosOut = _mm_xor_ps(cosValue, cosSign);
+        }
+
+        inline __m128 Atan2x4(__m128 y, __m128 x)
+        {
+            const __m128 signMask = _mm_set1_ps(-0.f);
+            __m128 ax = _mm_andnot_ps(signMask, x);
+            __m128 ay = _mm_andnot_ps(signMask, y);
+            __m128 maxValue = _mm_max_ps(ax, ay);
+            __m128 minValue = _mm_min_ps(ax, ay);
+            __m128 nonZero = _mm_cmpgt_ps(maxValue, _mm_setzero_ps());
+            __m128 a = _mm_and_ps(_mm_div_ps(minValue, maxValue), nonZero);
+
+            __m128 z = _mm_mul_ps(a, a);
+            __m128 p = _mm_add_ps(_mm_set1_ps(atan5), _mm_mul_ps(z, _mm_set1_ps(atan6)));
+            p = _mm_add_ps(_mm_set1_ps(atan4), _mm_mul_ps(z, p));
+            p = _mm_add_ps(_mm_set1_ps(atan3), _mm_mul_ps(z, p));
+            p = _mm_add_ps(_mm_set1_ps(atan2c), _mm_mul_ps(z, p));
+            p = _mm_add_ps(_mm_set1_ps(atan1), _mm_mul_ps(z, p));
+            __m128 r = _mm_mul_ps(a, p);
+
+            r = Select(_mm_cmpgt_ps(ay, ax), _mm_sub_ps(_mm_set1_ps(halfPi), r), r);
+            r = Select(_mm_cmplt_ps(x, _mm_setzero_ps()), _mm_sub_ps(_mm_set1_ps(piVal), r), r);
+            return Select(_mm_cmplt_ps(y, _mm_setzero_ps()), _mm_xor_ps(r, signMask), r);
+        }
+    }
+#endif
+
+    inline void SinCosBatch(const float* angles, float* sinOut, float* cosOut, std::size_t count)
+    {
+        std::size_t i = 0;
+#if defined(__AVX2__)
+        for (; i + 8 <= count; i += 8)
+        {
+            __m256 s, c;
+            detail::SinCos8(_mm256_loadu_ps(angles + i), s, c);
+            _mm256_storeu_ps(sinOut + i, s);
+            _mm256_storeu_ps(cosOut + i, c);
+        }
+#endif
+#ifdef FASTTRIG_SSE2
+        for (; i + 4 <= count; i += 4)
+        {
+            __m128 s, c;
+            detail::SinCos4(_mm_loadu_ps(angles + i), s, c);
+            _mm_storeu_ps(sinOut + i, s);
+            _mm_storeu_ps(cosOut + i, c);
+        }
+#endif
+        for (std::size_t tail = count - i; tail > 0; --tail, ++i)
+        {
+            SinCos(angles[i], sinOut[i], cosOut[i]);
+        }
+    }
+
+    inline void Atan2Batch(const float* y, const float* x, float* out, std::size_t count)
+    {
+        std::size_t i = 0;
+#if defined(__AVX2__)
+        for (; i + 8 <= count; i += 8)
+        {
+            _mm256_storeu_ps(out + i, detail::Atan2x8(_mm256_loadu_ps(y + i), _mm256_loadu_ps(x + i)));
+        }
+#endif
+#ifdef FASTTRIG_SSE2
+        for (; i + 4 <= count; i += 4)
+        {
+            _mm_storeu_ps(out + i, detail::Atan2x4(_mm_loadu_ps(y + i), _mm_loadu_ps(x + i)));
+        }
+#endif
+        for (std::size_t tail = count - i; tail > 0; --tail, ++i)
+        {
+            out[i] = Atan2(y[i], x[i]);
+        }
+    }
+}
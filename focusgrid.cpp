@@ -0,0 +1,219 @@
+//---------------------Uniform grid index over actors for focus cone queries---------------------------
+#include "focusgrid.h"
+#include "fasttrig.h"
+#include <algorithm>
+#include <cmath>
+
+namespace
+{
+    const float piVal {3.14159265358979323846f};
+
+    inline float Cross(sf::Vector2f a, sf::Vector2f b)
+    {
+        return a.x * b.y - a.y * b.x;
+    }
+}
+
+FocusGrid::FocusGrid(sf::Vector2f worldSize, float cellSize) :
+    cellSize(cellSize),
+    cols(std::max(1, static_cast<int>(std::ceil(worldSize.x / cellSize)))),
+    rows(std::max(1, static_cast<int>(std::ceil(worldSize.y / cellSize)))),
+    cells(std::size_t(cols) * rows),
+    slice(0),
+    margin(0.f),
+    movedCount(0),
+    testedCount(0)
+{
+}
+
+// Same arithmetic as the slice pass in Update, an actor must land in the same cell either way
+int FocusGrid::CellIndex(float x, float y) const
+{
+    const float invCellSize = 1.f / cellSize;
+    float cellX = std::max(0.f, std::min(static_cast<float>(cols - 1), x * invCellSize));
+    float cellY = std::max(0.f, std::min(static_cast<float>(rows - 1), y * invCellSize));
+    return static_cast<int>(cellY) * cols + static_cast<int>(cellX);
+}
+
+void FocusGrid::Update(const float* posX, const float* posY, std::size_t count, float maxMove)
+{
+    // The store shrank, start over
+    if (cellOf.size() > count)
+    {
+        for (std::vector<std::uint32_t>& cell : cells)
+        {
+            cell.clear();
+        }
+        cellOf.clear();
+        slotOf.clear();
+        hits.clear();
+    }
+
+    // Only one slice is re-filed per step, so every actor is checked every sliceCount steps and has
+    // drifted at most the sum of the last sliceCount moves from the cell it is filed under
+    std::size_t known = cellOf.size();
+    std::size_t sliceSize = (known + sliceCount - 1) / sliceCount;
+    std::size_t first = std::min(known, std::size_t(slice) * sliceSize);
+    std::size_t end = std::min(known, first + sliceSize);
+    recentMoves[slice] = maxMove;
+    slice = (slice + 1) % sliceCount;
+    margin = 0.f;
+    for (float move : recentMoves)
+    {
+        margin += move;
+    }
+
+    // Cells for the whole slice in a flat loop the compiler vectorizes, then the few that changed are moved
+    sliceCells.resize(sliceSize);
+    const float invCellSize = 1.f / cellSize;
+    const float maxX = static_cast<float>(cols - 1);
+    const float maxY = static_cast<float>(rows - 1);
+    const int stride = cols;
+    std::uint32_t* __restrict sliceCell = sliceCells.data();
+    for (std::size_t i = first; i < end; ++i)
+    {
+        float cellX = std::max(0.f, std::min(maxX, posX[i] * invCellSize));
+        float cellY = std::max(0.f, std::min(maxY, posY[i] * invCellSize));
+        sliceCell[i - first] = static_cast<std::uint32_t>(static_cast<int>(cellY) * stride + static_cast<int>(cellX));
+    }
+
+    movedCount = 0;
+    for (std::size_t i = first; i < end; ++i)
+    {
+        std::uint32_t cell = sliceCell[i - first];
+        if (cell == cellOf[i])
+            continue;
+
+        // Swap remove from the old cell, the actor moved into the hole takes over the slot
+        std::vector<std::uint32_t>& from = cells[cellOf[i]];
+        std::uint32_t last = from.back();
+        from[slotOf[i]] = last;
+        slotOf[last] = slotOf[i];
+        from.pop_back();
+
+        slotOf[i] = static_cast<std::uint32_t>(cells[cell].size());
+        cells[cell].push_back(static_cast<std::uint32_t>(i));
+        cellOf[i] = cell;
+        ++movedCount;
+    }
+
+    for (std::size_t i = known; i < count; ++i)
+    {
+        std::uint32_t cell = static_cast<std::uint32_t>(CellIndex(posX[i], posY[i]));
+        cellOf.push_back(cell);
+        slotOf.push_back(static_cast<std::uint32_t>(cells[cell].size()));
+        cells[cell].push_back(static_cast<std::uint32_t>(i));
+    }
+}
+
+// A cone up to 180 degrees is the intersection of the half planes left of edgeStart and right of
+// edgeEnd, a wider one is their union. The cell is judged by its four corners against both.
+FocusGrid::CellCoverage FocusGrid::Classify(int cellX, int cellY, sf::Vector2f apex, float radius, sf::Vector2f edgeStart, sf::Vector2f edgeEnd,
+                                            bool convex) const
+{
+    // Widened by how far a filed actor may have drifted out of its cell
+    float x0 = cellX * cellSize - margin - apex.x;
+    float y0 = cellY * cellSize - margin - apex.y;
+    float x1 = x0 + cellSize + 2.f * margin;
+    float y1 = y0 + cellSize + 2.f * margin;
+
+    float nearX = std::max(x0, std::min(0.f, x1));
+    float nearY = std::max(y0, std::min(0.f, y1));
+    if (nearX * nearX + nearY * nearY > radius * radius)
+        return CellOutside;
+
+    const sf::Vector2f corners[4] = { {x0, y0}, {x1, y0}, {x0, y1}, {x1, y1} };
+    int withinRadius = 0;
+    int leftOfStart = 0;
+    int rightOfEnd = 0;
+    int inGap = 0;
+    for (const sf::Vector2f& corner : corners)
+    {
+        bool left = Cross(edgeStart, corner) >= 0.f;
+        bool right = Cross(corner, edgeEnd) >= 0.f;
+        withinRadius += corner.x * corner.x + corner.y * corner.y <= radius * radius;
+        leftOfStart += left;
+        rightOfEnd += right;
+        inGap += !left && !right;
+    }
+
+    if (convex)
+    {
+        if (leftOfStart == 0 || rightOfEnd == 0)
+            return CellOutside;
+        if (leftOfStart == 4 && rightOfEnd == 4 && withinRadius == 4)
+            return CellInside;
+    }
+    else
+    {
+        if (inGap == 4)
+            return CellOutside;
+        if ((leftOfStart == 4 || rightOfEnd == 4) && withinRadius == 4)
+            return CellInside;
+    }
+    return CellPartial;
+}
+
+const std::vector<std::uint32_t>& FocusGrid::QuerySector(const float* posX, const float* posY, const float* listenerDistance,
+                                                         sf::Vector2f apex, float focusRadian, float sectorWidth, float radius,
+                                                         std::uint8_t* inFocus)
+{
+    for (std::uint32_t index : hits)
+    {
+        inFocus[index] = 0;
+    }
+    hits.clear();
+    testedCount = 0;
+
+    float focusX, focusY, sinHalfWidth, cosHalfWidth;
+    fasttrig::SinCos(focusRadian, focusY, focusX);
+    fasttrig::SinCos(sectorWidth * 0.5f, sinHalfWidth, cosHalfWidth);
+    sf::Vector2f edgeStart, edgeEnd;
+    fasttrig::SinCos(focusRadian - sectorWidth * 0.5f, edgeStart.y, edgeStart.x);
+    fasttrig::SinCos(focusRadian + sectorWidth * 0.5f, edgeEnd.y, edgeEnd.x);
+    bool convex = sectorWidth <= piVal;
+
+    float reach = radius + margin;
+    int minX = std::max(0, static_cast<int>(std::floor((apex.x - reach) / cellSize)));
+    int maxX = std::min(cols - 1, static_cast<int>(std::floor((apex.x + reach) / cellSize)));
+    int minY = std::max(0, static_cast<int>(std::floor((apex.y - reach) / cellSize)));
+    int maxY = std::min(rows - 1, static_cast<int>(std::floor((apex.y + reach) / cellSize)));
+
+    for (int cellY = minY; cellY <= maxY; ++cellY)
+    {
+        for (int cellX = minX; cellX <= maxX; ++cellX)
+        {
+            const std::vector<std::uint32_t>& cell = cells[std::size_t(cellY) * cols + cellX];
+            if (cell.empty())
+                continue;
+
+            CellCoverage coverage = Classify(cellX, cellY, apex, radius, edgeStart, edgeEnd, convex);
+            // Border cells also hold actors clamped in from outside the world, those are always tested
+            bool border = cellX == 0 || cellY == 0 || cellX == cols - 1 || cellY == rows - 1;
+            if (coverage == CellOutside && !border)
+                continue;
+
+            if (coverage == CellInside && !border)
+            {
+                hits.insert(hits.end(), cell.begin(), cell.end());
+                continue;
+            }
+
+            testedCount += cell.size();
+            for (std::uint32_t index : cell)
+            {
+                float dx = posX[index] - apex.x;
+                float dy = posY[index] - apex.y;
+                float dot = dx * focusX + dy * focusY;
+                if (listenerDistance[index] <= radius && dot >= cosHalfWidth * listenerDistance[index])
+                    hits.push_back(index);
+            }
+        }
+    }
+
+    for (std::uint32_t index : hits)
+    {
+        inFocus[index] = 1;
+    }
+    return hits;
+}
@@ -0,0 +1,64 @@
+//---------------------Uniform grid index over actors for focus cone queries---------------------------
+#pragma once
+
+#include <SFML/System/Vector2.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Actors are bucketed into square cells. The grid is loose: each Update re-files one slice of the
+// actors round robin, and cells are treated as widened by the distance an actor can have drifted
+// since it was last filed, so queries stay exact while the per-step upkeep is a fraction of the
+// actors. A sector query classifies the cells under the cone's bounding box: cells fully outside
+// are skipped, cells fully inside are taken whole, and only the cells on the cone's edge test
+// their actors one by one. The previous result is cleared from its own list, so the cost follows
+// the size of the cone rather than the actor count.
+class FocusGrid
+{
+public:
+    FocusGrid(sf::Vector2f worldSize, float cellSize = 48.f);
+
+    // maxMove bounds how far any actor moved since the previous Update. Positions outside the world
+    // are clamped to the border cells. Actors past the last call are added.
+    void Update(const float* posX, const float* posY, std::size_t count, float maxMove);
+
+    // Same test as ActorStore::UpdateFocus: within radius, and the angle to focusRadian is under
+    // half of sectorWidth. Writes 1 into inFocus for every hit and 0 for the previous query's
+    // hits that fell out. Returns the indices of the actors in the cone.
+    const std::vector<std::uint32_t>& QuerySector(const float* posX, const float* posY, const float* listenerDistance,
+                                                  sf::Vector2f apex, float focusRadian, float sectorWidth, float radius,
+                                                  std::uint8_t* inFocus);
+
+    // Diagnostics for the last Update and QuerySector
+    std::size_t GetMovedCount() const { return movedCount; }
+    std::size_t GetTestedCount() const { return testedCount; }
+
+private:
+    enum CellCoverage
+    {
+        CellOutside,
+        CellPartial,
+        CellInside
+    };
+
+    int CellIndex(float x, float y) const;
+    CellCoverage Classify(int cellX, int cellY, sf::Vector2f apex, float radius, sf::Vector2f edgeStart, sf::Vector2f edgeEnd, bool convex) const;
+
+    static constexpr int sliceCount = 8;
+
+    float cellSize;
+    int cols;
+    int rows;
+
+    std::vector<std::vector<std::uint32_t>> cells;
+    std::vector<std::uint32_t> cellOf;
+    std::vector<std::uint32_t> slotOf;
+    int slice;
+    float recentMoves[sliceCount] = {};
+    float margin;
+    std::vector<std::uint32_t> sliceCells;
+
+    std::vector<std::uint32_t> hits;
+    std::size_t movedCount;
+    std::size_t testedCount;
+};
@@ -0,0 +1,29 @@
+//---------------------Focus cone fan geometry---------------------------
+#include "focusshape.h"
+#include "fasttrig.h"
+#include <vector>
+
+// Focus shape modifier and color initialize
+void UpdateFocusShape(sf::VertexArray& shape, sf::Vector2f center, float radius, float startAngle, float endAngle, sf::Color color)
+{
+    shape[0].position = center;
+    shape[0].color = color;
+
+    // All rim angles go through one batched sincos call
+    size_t rimCount = shape.getVertexCount() - 1;
+    static thread_local std::vector<float> angles, sines, cosines;
+    angles.resize(rimCount);
+    sines.resize(rimCount);
+    cosines.resize(rimCount);
+    for(size_t i = 0; i < rimCount; ++i)
+    {
+        angles[i] = startAngle + (endAngle - startAngle) * i / (rimCount - 1);
+    }
+    fasttrig::SinCosBatch(angles.data(), sines.data(), cosines.data(), rimCount);
+
+    for(size_t i = 1; i < shape.getVertexCount(); ++i)
+    {
+        shape[i].position = center + sf::Vector2f(cosines[i - 1] * radius, sines[i - 1] * radius);
+        shape[i].color = sf::Color(0, 0, 0, 0);
+    }
+}
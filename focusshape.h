@@ -0,0 +1,7 @@
+//---------------------Focus cone fan geometry---------------------------
+#pragma once
+
+#include <SFML/Graphics.hpp>
+
+// Fills a TriangleFan: vertex 0 at center in color, the rim fading to transparent along the arc
+void UpdateFocusShape(sf::VertexArray& shape, sf::Vector2f center, float radius, float startAngle, float endAngle, sf::Color color);
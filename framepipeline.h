@@ -0,0 +1,41 @@
+//---------------------Lock free triple buffer for handing frames between threads---------------------------
+#pragma once
+
+#include <array>
+#include <atomic>
+
+// One producer writes into its own buffer and publishes it, one consumer picks up the
+// newest published buffer. Neither side ever waits, stale frames are simply skipped.
+template <typename T>
+class TripleBuffer
+{
+public:
+    // Producer side
+    T& WriteBuffer() { return buffers[writeIndex]; }
+
+    void Publish()
+    {
+        writeIndex = middle.exchange(writeIndex | dirtyBit, std::memory_order_acq_rel) & indexMask;
+    }
+
+    // Consumer side, returns false when nothing new was published since the last call
+    bool Acquire()
+    {
+        if ((middle.load(std::memory_order_acquire) & dirtyBit) == 0)
+            return false;
+
+        readIndex = middle.exchange(readIndex, std::memory_order_acq_rel) & indexMask;
+        return true;
+    }
+
+    const T& ReadBuffer() const { return buffers[readIndex]; }
+
+private:
+    static const int dirtyBit = 4;
+    static const int indexMask = 3;
+
+    std::array<T, 3> buffers;
+    std::atomic<int> middle{ 1 };
+    int writeIndex = 0;
+    int readIndex = 2;
+};
@@ -0,0 +1,123 @@
+//---------------------Retained grid layer cached in a render texture---------------------------
+#include "gridlayer.h"
+#include "fasttrig.h"
+#include <cmath>
+#include <iostream>
+
+namespace
+{
+    const float degToRad {3.14159265358979323846f / 180.f};
+
+    // Shortest distance between two angles in degrees
+    float AngleDistance(float a, float b)
+    {
+        float difference = std::fmod(std::abs(a - b), 360.f);
+        return difference > 180.f ? 360.f - difference : difference;
+    }
+}
+
+GridLayer::GridLayer() :
+    cols(0),
+    rows(0),
+    gridReso(0),
+    angleThreshold(0.5f),
+    renderedDegree(0.f),
+    dirty(true),
+    cacheHits(0),
+    rerenders(0),
+    glyphs(sf::PrimitiveType::Points)
+{
+}
+
+bool GridLayer::Configure(const std::vector<float>& newRotationAngles, int newCols, int newRows, int newGridReso, sf::Vector2u newSize)
+{
+    if (newSize.x != size.x || newSize.y != size.y)
+    {
+        if (!texture.create(newSize.x, newSize.y))
+        {
+            std::cerr << "Failed to create grid layer render texture." << std::endl;
+            return false;
+        }
+        sprite.setTexture(texture.getTexture(), true);
+        size = newSize;
+    }
+
+    rotationAngles = newRotationAngles;
+    cols = newCols;
+    rows = newRows;
+    gridReso = newGridReso;
+
+    glyphs.resize(rotationAngles.size() * gridReso);
+
+    dirty = true;
+    return true;
+}
+
+void GridLayer::Draw(sf::RenderTarget& target, float focusDegree)
+{
+    if (dirty || AngleDistance(focusDegree, renderedDegree) > angleThreshold)
+    {
+        Rerender(focusDegree);
+    }
+    else
+    {
+        ++cacheHits;
+    }
+
+    target.draw(sprite);
+}
+
+void BuildGridGlyphs(sf::VertexArray& glyphs, const std::vector<float>& rotationAngles, int cols, int rows, int gridReso,
+                     sf::Vector2u size, float focusDegree, GridGlyphScratch& scratch)
+{
+    std::vector<float>& radians = scratch.radians;
+    std::vector<float>& sines = scratch.sines;
+    std::vector<float>& cosines = scratch.cosines;
+    radians.resize(rotationAngles.size());
+    sines.resize(rotationAngles.size());
+    cosines.resize(rotationAngles.size());
+
+    // Every cell rotation in one batched sincos pass
+    for (size_t i = 0; i < rotationAngles.size(); ++i)
+    {
+        radians[i] = (rotationAngles[i] + focusDegree) * degToRad;
+    }
+    fasttrig::SinCosBatch(radians.data(), sines.data(), cosines.data(), radians.size());
+
+    // All glyphs go into one point list, a line from the cell center along the rotated y axis
+    sf::Color gridColor = sf::Color(255, 255, 255, 100);
+    int cellWidth = static_cast<int>(size.x) / cols;
+    int cellHeight = static_cast<int>(size.y) / rows;
+    size_t vertex = 0;
+    for (int y = 0; y < rows; ++y)
+    {
+        for (int x = 0; x < cols; ++x)
+        {
+            int index = y * cols + x;
+            sf::Vector2f cellCenter(4 + cellWidth * x, 4 + cellHeight * y);
+
+            glyphs[vertex].position = cellCenter;
+            glyphs[vertex].color = gridColor;
+            ++vertex;
+            for (int i = 1; i < gridReso; ++i)
+            {
+                glyphs[vertex].position = sf::Vector2f(cellCenter.x - sines[index] * i, cellCenter.y + cosines[index] * i);
+                glyphs[vertex].color = gridColor;
+                ++vertex;
+            }
+        }
+    }
+}
+
+void GridLayer::Rerender(float focusDegree)
+{
+    BuildGridGlyphs(glyphs, rotationAngles, cols, rows, gridReso, size, focusDegree, scratch);
+
+    texture.clear(sf::Color::Transparent);
+    texture.draw(glyphs);
+    texture.display();
+
+    renderedDegree = focusDegree;
+    dirty = false;
+    ++rerenders;
+}
@@ -0,0 +1,58 @@
+//---------------------Retained grid layer cached in a render texture---------------------------
+#pragma once
+
+#include <SFML/Graphics.hpp>
+#include <cstdint>
+#include <vector>
+
+// Per-cell trig for BuildGridGlyphs, kept around so rebuilds do not allocate
+struct GridGlyphScratch
+{
+    std::vector<float> radians;
+    std::vector<float> sines;
+    std::vector<float> cosines;
+};
+
+// Glyph point list for one focus angle, plain CPU work with no GL involved.
+// glyphs must hold rotationAngles.size() * gridReso vertices.
+void BuildGridGlyphs(sf::VertexArray& glyphs, const std::vector<float>& rotationAngles, int cols, int rows, int gridReso,
+                     sf::Vector2u size, float focusDegree, GridGlyphScratch& scratch);
+
+// The grid only depends on the static field angles and one global focus angle, so it is
+// rendered into a texture and re-rendered only when the focus angle moved past the
+// threshold or the field/resolution changed. Every other frame draws one textured quad.
+class GridLayer
+{
+public:
+    GridLayer();
+
+    // Field angles in degrees, cols * rows entries, each glyph is gridReso pixels long
+    bool Configure(const std::vector<float>& rotationAngles, int cols, int rows, int gridReso, sf::Vector2u size);
+    void SetAngleThreshold(float degrees) { angleThreshold = degrees; }
+
+    void Draw(sf::RenderTarget& target, float focusDegree);
+
+    std::uint64_t GetCacheHits() const { return cacheHits; }
+    std::uint64_t GetRerenders() const { return rerenders; }
+
+private:
+    void Rerender(float focusDegree);
+
+    std::vector<float> rotationAngles;
+    int cols;
+    int rows;
+    int gridReso;
+    sf::Vector2u size;
+
+    float angleThreshold;
+    float renderedDegree;
+    bool dirty;
+
+    std::uint64_t cacheHits;
+    std::uint64_t rerenders;
+
+    sf::RenderTexture texture;
+    sf::Sprite sprite;
+    sf::VertexArray glyphs;
+    GridGlyphScratch scratch;
+};
@@ -18,6 +18,7 @@
  * If not, see <http://creativecommons.org/publicdomain/zero/1.0/>.*/
 
 #include <iostream>
+#include <string>
 #include <cmath>
 #include <SFML/Graphics.hpp>
 #include <SFML/Audio.hpp>
@@ -25,110 +26,386 @@
 #include "phonon.h"
 #include "steamaudiomanager.h"
 #include "PerlinNoise.hpp"
+#include "SimplexNoise.hpp"
+#include "actorstore.h"
+#include "focusshape.h"
+#include "framepipeline.h"
+#include "gridlayer.h"
+#include "particlefield.h"
+#include "simulation.h"
+#include "spatialmixer.h"
+#include "audioconfig.h"
+#include "assetbundle.h"
+#include "audioasset.h"
+#include "audiooutput.h"
+#include "startupgraph.h"
+#include "qualitygovernor.h"
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <climits>
+#include <cstdlib>
+#include <memory>
+#include <mutex>
+#include <thread>
 
 // Screen Size
 const int sW {1920};
 const int sH {1080};
 
 // Other trivial constants
-const float piVal {3.14159265358979323846};
 const float movementSpeed {300.f};
-const float radarSpeed {1500.f};
-
-// Keyboard input method 
-void InputMovement(sf::Vector2f& ballPos, float deltaTime) {
-    if (sf::Keyboard::isKeyPressed(sf::Keyboard::W)) ballPos.y -= movementSpeed * deltaTime;
-    if (sf::Keyboard::isKeyPressed(sf::Keyboard::S)) ballPos.y += movementSpeed * deltaTime;
-    if (sf::Keyboard::isKeyPressed(sf::Keyboard::D)) ballPos.x += movementSpeed * deltaTime;
-    if (sf::Keyboard::isKeyPressed(sf::Keyboard::A)) ballPos.x -= movementSpeed * deltaTime;
+const float simTimestep {1.f / 120.f};
+
+// Keyboard input method, the actor store integrates the resulting velocity
+void InputMovement(sf::Vector2f& velocity) {
+    velocity = {0.f, 0.f};
+    if (sf::Keyboard::isKeyPressed(sf::Keyboard::W)) velocity.y -= movementSpeed;
+    if (sf::Keyboard::isKeyPressed(sf::Keyboard::S)) velocity.y += movementSpeed;
+    if (sf::Keyboard::isKeyPressed(sf::Keyboard::D)) velocity.x += movementSpeed;
+    if (sf::Keyboard::isKeyPressed(sf::Keyboard::A)) velocity.x -= movementSpeed;
 }
 
-// Focus shape modifier and color initialize
-void UpdateFocusShape(sf::VertexArray& shape, sf::Vector2f center, float radius, float startAngle, float endAngle, sf::Color color)
+// Command line numbers, false on anything but a whole in-range number. value is raised to minimum.
+bool ParseInt(const char* text, int minimum, int& value)
 {
-    shape[0].position = center;
-    shape[0].color = color;
+    char* end = nullptr;
+    errno = 0;
+    long parsed = std::strtol(text, &end, 10);
+    if (end == text || *end != '\0' || errno == ERANGE || parsed < INT_MIN || parsed > INT_MAX)
+        return false;
+    value = std::max(minimum, static_cast<int>(parsed));
+    return true;
+}
 
-    for(size_t i = 1; i < shape.getVertexCount(); ++i)
-    {
-        float angle = startAngle + (endAngle - startAngle) * (i - 1) / (shape.getVertexCount() - 2);
-        shape[i].position = center + sf::Vector2f(std::cos(angle) * radius, std::sin(angle) * radius);
-        shape[i].color = sf::Color(0, 0, 0, 0);
-    }
+bool ParseFloat(const char* text, float minimum, float& value)
+{
+    char* end = nullptr;
+    errno = 0;
+    float parsed = std::strtof(text, &end);
+    if (end == text || *end != '\0' || errno == ERANGE || !std::isfinite(parsed))
+        return false;
+    value = std::max(minimum, parsed);
+    return true;
 }
 
-// Radar circle action
-void UpdateRadarShape(sf::CircleShape& radarCircle, float& radarRadius, float maxRadarRadius, float deltaTime, bool& isRadarExpanding)
+// Flow field angles in degrees for the background grid. Cells are sampled at their pixel position,
+// so the field keeps its shape when the quality governor changes the grid resolution.
+template <typename Noise>
+void FillFlowField(const Noise& noise, int gridReso, int cols, int rows, std::vector<float>& rotationAngles)
 {
-    if (isRadarExpanding)
+    const double scale = 0.05 / 20.0;
+    rotationAngles.resize(std::size_t(cols) * rows);
+    for (int y = 0; y < rows; ++y)
     {
-        radarRadius += radarSpeed * deltaTime;
-        float alphaPercentage = 1.0f - (radarRadius / maxRadarRadius);
-        int alpha = static_cast<int>(255 * alphaPercentage);
-        alpha = std::max(0, std::min(50, alpha));
-        radarCircle.setFillColor(sf::Color(255, 255, 255, alpha));
-
-        if (radarRadius >= maxRadarRadius)
+        for (int x = 0; x < cols; ++x)
         {
-            isRadarExpanding = false;
-            radarRadius = 10.f;
+            // Sample from the Perlin noise
+            double noiseValue = noise.noise2D(x * gridReso * scale, y * gridReso * scale);
+
+            // Map noise value from [-1, 1] to [0, 1]
+            noiseValue = (noiseValue + 1.0) / 2.0;
+
+            // Map noise value to a rotation angle [0, 360] degrees
+            rotationAngles[std::size_t(y) * cols + x] = static_cast<float>(noiseValue * 360.0);
         }
-        radarCircle.setRadius(radarRadius);
-        radarCircle.setOrigin(radarRadius, radarRadius);
     }
 }
 
-// Focus shape modifier and color initialize
-void DrawGridInstance(sf::VertexArray& shape, sf::Vector2f center, float rotationAngle)
+// Same grid with the angle taken from the curl of the Perlin field, so neighbouring cells flow
+// around each other instead of converging on the noise minima
+void FillCurlField(const siv::PerlinNoise& noise, int gridReso, int cols, int rows, std::vector<float>& rotationAngles)
 {
-    sf::Color gridColor = sf::Color(255, 255, 255, 100);
-    sf::Transform transform;
-    shape[0].position = center;
-    shape[0].color = gridColor;
-    transform.rotate(rotationAngle, center);
-
-    for(size_t i = 1; i < shape.getVertexCount(); ++i)
-    {    
-        shape[i].position = transform.transformPoint(sf::Vector2f(center.x, center.y + i));
-        shape[i].color = gridColor;   
+    const double scale = 0.05 / 20.0;
+    rotationAngles.resize(std::size_t(cols) * rows);
+    for (int y = 0; y < rows; ++y)
+    {
+        for (int x = 0; x < cols; ++x)
+        {
+            std::array<double, 2> flow = noise.curl2D(x * gridReso * scale, y * gridReso * scale);
+            double angle = std::atan2(flow[1], flow[0]) * 180.0 / 3.14159265358979;
+            rotationAngles[std::size_t(y) * cols + x] = static_cast<float>(angle < 0.0 ? angle + 360.0 : angle);
+        }
     }
 }
 
-int main()
+int main(int argc, char* argv[])
 {
-    // Sfml window initialization and frame limit
+    // Command line options
+    std::string sofaFile;
+    int actorCount = 1000;
+    float gridThreshold = 0.5f;
+    bool latencyTest = false;
+    AudioConfig audioConfig;
+    std::string bundlePath = "assets/assets.bundle";
+    std::string ambienceFile;
+    float prefetchSeconds = 0.5f;
+    bool doppler = true;
+    std::string outputSpec = "sfml";
+    AudioOutputSettings outputSettings;
+    outputSettings.periodFrames = 0;
+    int pinnedQuality = -1;
+    std::string noiseField = "perlin";
+    int particleCount = 100000;
+    int particleThreads = 0;
+    for (int i = 1; i < argc; ++i)
+    {
+        std::string arg = argv[i];
+        bool valid = true;
+        int memoryCapMegabytes = 0;
+        if (arg == "--hrtf" && i + 1 < argc)
+            sofaFile = argv[++i];
+        else if (arg == "--actors" && i + 1 < argc)
+            valid = ParseInt(argv[++i], 0, actorCount);
+        else if (arg == "--grid-threshold" && i + 1 < argc)
+            valid = ParseFloat(argv[++i], 0.f, gridThreshold);
+        else if (arg == "--latency-test")
+            latencyTest = true;
+        else if (arg == "--rate" && i + 1 < argc)
+            valid = ParseInt(argv[++i], 8000, audioConfig.samplingRate);
+        else if (arg == "--block" && i + 1 < argc)
+            valid = ParseInt(argv[++i], 32, audioConfig.frameSize);
+        else if (arg == "--bundle" && i + 1 < argc)
+            bundlePath = argv[++i];
+        else if (arg == "--loose-assets")
+            bundlePath.clear();
+        else if (arg == "--simd" && i + 1 < argc)
+            audioConfig.simdLevel = argv[++i];
+        else if (arg == "--audio-memory-cap" && i + 1 < argc)
+        {
+            valid = ParseInt(argv[++i], 0, memoryCapMegabytes);
+            audioConfig.memoryCapBytes = static_cast<std::size_t>(memoryCapMegabytes) << 20;
+        }
+        else if (arg == "--ambience" && i + 1 < argc)
+            ambienceFile = argv[++i];
+        else if (arg == "--prefetch" && i + 1 < argc)
+            valid = ParseFloat(argv[++i], 0.05f, prefetchSeconds);
+        else if (arg == "--no-doppler")
+            doppler = false;
+        else if (arg == "--output" && i + 1 < argc)
+            outputSpec = argv[++i];
+        else if (arg == "--period" && i + 1 < argc)
+            valid = ParseInt(argv[++i], 16, outputSettings.periodFrames);
+        else if (arg == "--periods" && i + 1 < argc)
+            valid = ParseInt(argv[++i], 2, outputSettings.periodCount);
+        else if (arg == "--noise" && i + 1 < argc)
+            noiseField = argv[++i];
+        else if (arg == "--particles" && i + 1 < argc)
+            valid = ParseInt(argv[++i], 0, particleCount);
+        else if (arg == "--particle-threads" && i + 1 < argc)
+            valid = ParseInt(argv[++i], 0, particleThreads);
+        else if (arg == "--quality" && i + 1 < argc)
+        {
+            std::string level = argv[++i];
+            if (level == "auto")
+                pinnedQuality = -1;
+            else
+                valid = ParseInt(argv[i], 0, pinnedQuality);
+        }
+
+        if (!valid)
+        {
+            std::cerr << "Invalid number for " << arg << ": " << argv[i] << std::endl;
+            return 1;
+        }
+    }
+
+    // Sfml window initialization and frame limit, opened first so the loading screen shows at once
+    const unsigned frameLimit = 60;
     sf::RenderWindow window(sf::VideoMode(sW, sH), "Audio Actor Test!");
-    window.setFramerateLimit(60);
+    window.setFramerateLimit(frameLimit);
 
-    // Sound buffer initialization and wave sound file load with sfml interface
+    // Starts at the best level and steps down when frames or audio blocks run late, --quality pins a level
+    QualityGovernor governor(1.f / frameLimit, std::max(0, pinnedQuality));
+    QualityGovernor::Level quality = governor.GetLevel();
+
+    // Filled in by the startup stages below, which run in parallel as soon as their inputs are ready
+    AssetBundle bundle;
+    AssetAudio radarClip;
+    AssetBlob fontBlob;
+    bool useBundle = false;
+    std::vector<float> radarFloatBuffer;
     sf::SoundBuffer radarBuffer;
-    if(!radarBuffer.loadFromFile("assets/audiofiles/radarSFX.wav"))
+    sf::Font font;
+    SteamAudioManager steamAudio;
+    // Compressed beds are decoded ahead on worker threads, the mixer only reads their rings
+    DecodeService decodeService(audioConfig.samplingRate);
+    std::unique_ptr<SpatialMixer> mixer;
+    std::unique_ptr<AudioOutput> audioOutput;
+    std::unique_ptr<Simulation> simulation;
+
+    // Noise background grid, classic Perlin, simplex or the curl of Perlin as the flow field source
+    siv::PerlinNoise perlin;
+    siv::SimplexNoise simplex;
+    int gridReso = quality.gridReso;
+    int gCols = sW / gridReso;
+    int gRows = sH / gridReso;
+    std::vector<float> rotationAngles;
+    auto fillFlowField = [&]()
     {
-        std::cerr << "Failed to load audio file." << std::endl;
-        return 1;
-    }
-    if (radarBuffer.getChannelCount() != 1) 
+        if (noiseField == "simplex")
+            FillFlowField(simplex, gridReso, gCols, gRows, rotationAngles);
+        else if (noiseField == "curl")
+            FillCurlField(perlin, gridReso, gCols, gRows, rotationAngles);
+        else
+            FillFlowField(perlin, gridReso, gCols, gRows, rotationAngles);
+    };
+
+    // Particles carried along the same field, advected on their own worker threads
+    ParticleField particles(particleThreads);
+    sf::VertexArray particleVertices(sf::PrimitiveType::Points);
+
+    StartupGraph startup;
+
+    // Assets come from the baked bundle when it matches the engine rate, loose files otherwise
+    int assetStage = startup.Add("assets", [&]()
     {
-    std::cerr << "Error: Sound file must be mono for binaural effect!" << std::endl;
-    }
+        useBundle = !bundlePath.empty() && bundle.Open(bundlePath);
+        if (useBundle && bundle.GetSamplingRate() != audioConfig.samplingRate)
+        {
+            std::cout << "Asset bundle is baked at " << bundle.GetSamplingRate() << " Hz, using loose assets" << std::endl;
+            useBundle = false;
+        }
+        if (useBundle && !(bundle.FindAudio("radar", radarClip) && bundle.FindBlob("font", fontBlob)))
+        {
+            std::cout << "Asset bundle is missing entries, using loose assets" << std::endl;
+            useBundle = false;
+        }
 
-    sf::Sound radarSound(radarBuffer);
+        // Loose path decodes, downmixes and resamples to the engine rate at startup
+        if (!useBundle)
+        {
+            if (!LoadMonoSamples("assets/audiofiles/radarSFX.wav", audioConfig.samplingRate, radarFloatBuffer))
+                return false;
+            radarClip.samples = radarFloatBuffer.data();
+            radarClip.sampleCount = radarFloatBuffer.size();
+            radarClip.samplingRate = audioConfig.samplingRate;
+        }
 
-    std::vector<float> radarFloatBuffer;
-    radarFloatBuffer.reserve(radarBuffer.getSampleCount() * radarBuffer.getChannelCount());
-    for (size_t i = 0; i < radarBuffer.getSampleCount() * radarBuffer.getChannelCount(); ++i)
+        FillSoundBuffer(radarClip.samples, radarClip.sampleCount, radarClip.samplingRate, radarBuffer);
+        return true;
+    });
+
+    // Sfml font load, the bundle's blob stays mapped for the lifetime of the font
+    startup.Add("font", [&]()
+    {
+        bool fontLoaded = useBundle ? font.loadFromMemory(fontBlob.data, fontBlob.size) : font.loadFromFile("assets/fonts/ARIAL.TTF");
+        if (!fontLoaded)
+            std::cerr << "Failed to load font file." << std::endl;
+        return fontLoaded;
+    }, { assetStage });
+
+    // Steam Audio context, HRTF and effects, the slowest stage with a SOFA HRTF
+    int hrtfStage = startup.Add("hrtf", [&]()
     {
-        radarFloatBuffer.push_back(static_cast<float>(radarBuffer.getSamples()[i]) / 32767.f);
+        bool initialized = steamAudio.Initialize(audioConfig, sofaFile);
+        steamAudio.DebugPrint();
+        return initialized;
+    });
+
+    // Spatialized pulses are mixed on the audio thread, one Steam Audio frame per block. Audio
+    // comes online here, while the window may still be loading.
+    int audioStage = startup.Add("audio", [&]()
+    {
+        mixer.reset(new SpatialMixer(steamAudio, radarClip.samples, radarClip.sampleCount));
+        mixer->SetDopplerEnabled(doppler);
+        if (!ambienceFile.empty())
+        {
+            int ambienceStream = decodeService.OpenStream(ambienceFile, prefetchSeconds, true);
+            if (ambienceStream >= 0)
+                mixer->AttachStream(decodeService, ambienceStream, {0.f, 0.f, -1.f});
+        }
+
+        // Float backends take the mix straight into their period buffers, SFML stays the default
+        if (outputSpec != "sfml")
+        {
+            outputSettings.samplingRate = audioConfig.samplingRate;
+            if (outputSettings.periodFrames == 0)
+                outputSettings.periodFrames = audioConfig.frameSize;
+            audioOutput = CreateAudioOutput(outputSpec);
+            if (audioOutput && !audioOutput->Open(outputSettings))
+                audioOutput.reset();
+            if (audioOutput)
+                std::cout << "Audio output " << audioOutput->GetName() << ": " << audioOutput->GetSettings().periodFrames << " frames x "
+                          << audioOutput->GetSettings().periodCount << " periods, " << audioOutput->GetLatencySeconds() * 1000.0 << " ms" << std::endl;
+            else
+                std::cout << "Falling back to SFML audio output" << std::endl;
+        }
+        mixer->SetVoiceLimit(quality.voiceCount);
+        mixer->SetBilinearHrtf(quality.bilinearHrtf);
+        if (!mixer->Start(audioOutput.get()))
+            mixer->Start();
+        return true;
+    }, { assetStage, hrtfStage });
+
+    // Actors are simulated on their own thread, the render thread only draws snapshots
+    startup.Add("simulation", [&]()
+    {
+        simulation.reset(new Simulation(*mixer, actorCount, {(float)sW, (float)sH}));
+        return true;
+    }, { audioStage });
+
+    // Flow field angles for the background grid
+    int noiseStage = startup.Add("noise", [&]()
+    {
+        fillFlowField();
+        return true;
+    });
+
+    startup.Add("particles", [&]()
+    {
+        particles.Reset(particleCount, {(float)sW, (float)sH});
+        return particles.SetField(rotationAngles, gCols, gRows, (float)gridReso);
+    }, { noiseStage });
+
+    // Loading screen, one bar per stage: grey waiting, amber running, green done, red failed
+    startup.Start();
+    while (!startup.IsFinished())
+    {
+        sf::Event event;
+        while (window.pollEvent(event))
+        {
+            // Closing lets the stages finish, then the main loop below exits right away
+            if (event.type == sf::Event::Closed)
+                window.close();
+        }
+        if (!window.isOpen())
+            break;
+
+        window.clear();
+        const float barWidth = 300.f;
+        const float barHeight = 12.f;
+        for (int s = 0; s < startup.GetStageCount(); ++s)
+        {
+            sf::Color color(80, 80, 80);
+            switch (startup.GetState(s))
+            {
+            case StartupGraph::StageRunning: color = sf::Color(230, 170, 40); break;
+            case StartupGraph::StageDone: color = sf::Color(60, 190, 90); break;
+            case StartupGraph::StageFailed:
+            case StartupGraph::StageSkipped: color = sf::Color(200, 50, 50); break;
+            default: break;
+            }
+            sf::RectangleShape bar({barWidth, barHeight});
+            bar.setPosition((sW - barWidth) * 0.5f, sH * 0.5f + (s - startup.GetStageCount() * 0.5f) * barHeight * 2.f);
+            bar.setFillColor(color);
+            window.draw(bar);
+        }
+        window.display();
     }
 
-    // Steam Audio Inıtialize
-    SteamAudioManager steamAudio;
-    steamAudio.Initialize();
-    steamAudio.DebugPrint();
+    bool started = startup.Wait();
+    startup.Report(std::cout);
+    if (!started)
+    {
+        if (mixer)
+            mixer->Shutdown();
+        steamAudio.CleanUp();
+        return 1;
+    }
 
-    IPLAudioSettings audioSettings{};
-    audioSettings.samplingRate = 44100;
-    audioSettings.frameSize = 512;
+    sf::Sound radarSound(radarBuffer);
 
     // Base clock and fps counter variables
     sf::Clock clock;
@@ -138,16 +415,7 @@ int main()
     float fpsUpdateInterval = 0.2f;
     float fpsVal = 0.f;
 
-    // Sfml font load
-    sf::Font font;
-    if(!font.loadFromFile("assets/fonts/ARIAL.TTF"))
-    {
-        std::cerr << "Failed to load font file." << std::endl;
-        return -1;
-    }
-
     // Drawable shape colors definitions
-    sf::Color circleColor(100, 100, 100);
     sf::Color focusColor(140, 10, 60);
 
     // Informative text
@@ -163,80 +431,86 @@ int main()
     fpsText.setFont(font);
     fpsText.setCharacterSize(20);
     fpsText.setFillColor(sf::Color::White); 
-    fpsText.setPosition(1750, 20);
+    fpsText.setPosition(1600, 20);
 
-    // Main Actor shape
-    sf::Vector2f ballPos = {sW/2, sH/2};
-    sf::CircleShape circleShape(20.f);
-    circleShape.setFillColor(circleColor);
-    circleShape.setOrigin(20.f, 20.f);
+    sf::VertexArray actorVertices(sf::PrimitiveType::Triangles);
 
     // Focus shape vertex array variable declarations
-    float outerRadius = 200.f;
-    float maxRadius = 1000.f;
-    float minRadius = 60.f;
-    float startAngle;
-    float endAngle;
-    int   segments = 100;
-
-    sf::VertexArray focusShape(sf::PrimitiveType::TriangleFan, segments);
+    sf::VertexArray focusShape(sf::PrimitiveType::TriangleFan, quality.segments);
 
     // Radar shape
     float radarRadius = 10.f;
-    float maxRadarRadius = 600.f;
     sf::CircleShape radarCircle(radarRadius);
     radarCircle.setOrigin(radarRadius, radarRadius);
-    bool isRadarExpanding = false;
 
-    // Perlin background grid
-    int gridReso = 20;
-    int gCols = sW / gridReso;
-    int gRows = sH / gridReso;
-    std::vector<float> rotationAngles(gCols * gRows);
-    sf::VertexArray gridShape(sf::PrimitiveType::Points, gridReso);
+    // Grid layer cached in a texture, re-rendered only when the focus angle moves enough
+    GridLayer gridLayer;
+    gridLayer.SetAngleThreshold(gridThreshold);
+    // Without its render texture the layer has nothing to draw, the rest of the scene still runs
+    bool gridLayerReady = gridLayer.Configure(rotationAngles, gCols, gRows, gridReso, {(unsigned)sW, (unsigned)sH});
+    if (!gridLayerReady)
+        std::cerr << "Grid layer disabled." << std::endl;
+
+    // Occluder walls drawn from the simulation's static geometry
+    const std::vector<OccluderSegment>& occluders = simulation->GetOccluders();
+    sf::VertexArray occluderShape(sf::PrimitiveType::Lines, occluders.size() * 2);
+    for (size_t i = 0; i < occluders.size(); ++i)
+    {
+        occluderShape[i * 2] = sf::Vertex(occluders[i].a, sf::Color(200, 200, 90));
+        occluderShape[i * 2 + 1] = sf::Vertex(occluders[i].b, sf::Color(200, 200, 90));
+    }
 
-    // Perlin Noise initialize
-    siv::PerlinNoise perlin;
-    double scale = 0.05;
+    sf::Mouse mouse;
+
+    // Simulation thread, fixed timestep, publishes one snapshot per step
+    TripleBuffer<FrameSnapshot> frames;
+    simulation->WriteSnapshot(frames.WriteBuffer(), 0.f);
+    frames.Publish();
+
+    std::mutex inputMutex;
+    InputState sharedInput;
+    sharedInput.mousePos = {sW / 2, sH / 2};
+    std::atomic<bool> simRunning {true};
 
-    for (int y = 0; y < gRows; ++y)
+    std::thread simThread([&]()
     {
-        for (int x = 0; x < gCols; ++x)
+        using SimClock = std::chrono::steady_clock;
+        const auto stepDuration = std::chrono::duration_cast<SimClock::duration>(std::chrono::duration<float>(simTimestep));
+        SimClock::time_point nextStep = SimClock::now();
+
+        while (simRunning)
         {
-            // Sample from the Perlin noise
-            double noiseValue = perlin.noise2D(x * scale, y * scale);
+            InputState input;
+            {
+                std::lock_guard<std::mutex> lock(inputMutex);
+                input = sharedInput;
+            }
 
-            // Map noise value from [-1, 1] to [0, 1]
-            noiseValue = (noiseValue + 1.0) / 2.0;
+            SimClock::time_point stepStart = SimClock::now();
+            simulation->Step(simTimestep, input);
+            float simMs = std::chrono::duration<float, std::milli>(SimClock::now() - stepStart).count();
 
-            // Map noise value to a rotation angle [0, 360] degrees
-            int index = y * gCols + x;
-            rotationAngles[index] = noiseValue * 360.0;
-        }
-    }
+            simulation->WriteSnapshot(frames.WriteBuffer(), simMs);
+            frames.Publish();
 
-    sf::Mouse mouse;
+            // Catch up after short stalls, but drop time instead of spiralling on long ones
+            nextStep += stepDuration;
+            if (SimClock::now() - nextStep > stepDuration * 8)
+                nextStep = SimClock::now();
+            std::this_thread::sleep_until(nextStep);
+        }
+    });
 
-    // ----------------- MAIN GAME LOOP ----------------------
+    // ----------------- MAIN RENDER LOOP ----------------------
     while(window.isOpen())
     {
-        sf::Vector2i mousePosINT = mouse.getPosition(window);
-        IPLVector3 dirVector = {(float)mousePosINT.x, 0, (float)mousePosINT.y};
-        std::vector<float> outputBuffer = steamAudio.ProcessAudio(radarFloatBuffer, dirVector);
-
-        // Convert back to SFML format
-        std::vector<sf::Int16> processedInt16(outputBuffer.size());
-        for (size_t i = 0; i < outputBuffer.size(); ++i) 
+        std::chrono::steady_clock::time_point frameStart = std::chrono::steady_clock::now();
+        InputState input;
         {
-            processedInt16[i] = static_cast<sf::Int16>(outputBuffer[i] * 32767.f);
+            std::lock_guard<std::mutex> lock(inputMutex);
+            input = sharedInput;
         }
 
-        sf::SoundBuffer processedBuffer;
-
-        processedBuffer.loadFromSamples(processedInt16.data(), processedInt16.size(), 2, audioSettings.samplingRate);
-
-        sf::Sound processedSound(processedBuffer);
-
         sf::Event event;
         while(window.pollEvent(event))
         {
@@ -247,24 +521,32 @@ int main()
             {
                 if(event.key.code == sf::Keyboard::F)
                 {
-                    processedSound.play();
-                    //radarSound.play();
-                    std::cout << "Spatialized Radar Pulse played." << std::endl;
-                    isRadarExpanding = true;
-                    radarRadius = 10.f;
+                    // Timestamped here, the mixer places it at the matching sample
+                    mixer->Trigger(std::chrono::steady_clock::now());
+                    std::cout << "Spatialized Radar Pulse queued." << std::endl;
                 }
                 if(event.key.code == sf::Keyboard::Space)
                 {
                     radarSound.play();
-                    std::cout << "Non-Spatialized Radar Pulse played." << std::endl;
-                    isRadarExpanding = true;
-                    radarRadius = 10.f;
+                    std::cout << "Non-Spatialized Radar Pulse queued." << std::endl;
+                    ++input.radarTriggers;
                 }
             }
         }
 
+        // Mouse position and keyboard movement handed to the simulation thread
+        sf::Vector2i mousePos = mouse.getPosition(window);
+        input.mousePos = sf::Vector2f((float)mousePos.x, (float)mousePos.y);
+        InputMovement(input.moveVelocity);
+        {
+            std::lock_guard<std::mutex> lock(inputMutex);
+            sharedInput = input;
+        }
+
         // Delta time and frame per second calculation
         float deltaTime = clock.restart().asSeconds();
+        float audioLoad = mixer->TakePeakLoad();
+        mixer->UpdateLatency();
         frameCount++;
         currentElapsedTime += deltaTime;
 
@@ -275,70 +557,107 @@ int main()
             frameCount = 0;
         }
 
-        // Mouse position and angle calculation with main actor
-        sf::Vector2i mousePos = mouse.getPosition(window);
-
-        float mouseBallDistance = std::sqrt(std::pow(mousePos.x - ballPos.x, 2) + std::pow(mousePos.y - ballPos.y, 2));        
-        float maxDistance = 800.f;
-
-        float focusRadian = std::atan2f(mousePos.y - ballPos.y, mousePos.x - ballPos.x);
-        float focusDegree = (focusRadian * 180) / piVal;
-
-        float normalizedDistance = std::min(mouseBallDistance, maxDistance) / maxDistance;
-
-        float invertedNormalizedDistance = 1.0f - normalizedDistance;
-
-        // Focus shape sector width 
-        outerRadius = minRadius + normalizedDistance * (maxRadius - minRadius);
-
-        float minSectorWidth = 5.0f * (piVal / 180.0f);
-        float maxSectorWidth = 240.0f * (piVal / 180.0f); 
-        float sectorWidth = minSectorWidth + invertedNormalizedDistance * (maxSectorWidth - minSectorWidth);
+        // Newest snapshot, blended from its previous step by the time since it was taken
+        frames.Acquire();
+        const FrameSnapshot& frame = frames.ReadBuffer();
+        float alpha = 1.f;
+        if (frame.timestep > 0.f)
+        {
+            float sinceStep = std::chrono::duration<float>(std::chrono::steady_clock::now() - frame.stepTime).count();
+            alpha = std::min(sinceStep / frame.timestep, 1.f);
+        }
+        sf::Vector2f ballPos = frame.listenerPrev + (frame.listener - frame.listenerPrev) * alpha;
 
-        startAngle = focusRadian - (sectorWidth * 0.5f);
-        endAngle = focusRadian + (sectorWidth * 0.5f);
+        UpdateFocusShape(focusShape, ballPos, frame.outerRadius, frame.startAngle, frame.endAngle, focusColor);
+        BuildActorVertices(actorVertices, frame.prevX.data(), frame.prevY.data(), frame.posX.data(), frame.posY.data(),
+                           frame.radius.data(), frame.color.data(), frame.posX.size(), alpha);
 
-        // Defined method calls for every iteration
-        InputMovement(ballPos, deltaTime);
-        UpdateFocusShape(focusShape, (sf::Vector2f){ballPos}, outerRadius, startAngle, endAngle, focusColor);
-        UpdateRadarShape(radarCircle, radarRadius, maxRadarRadius, deltaTime, isRadarExpanding);
+        radarRadius = frame.radarRadiusPrev + (frame.radarRadius - frame.radarRadiusPrev) * alpha;
+        radarCircle.setFillColor(sf::Color(255, 255, 255, frame.radarAlpha));
+        radarCircle.setRadius(radarRadius);
+        radarCircle.setOrigin(radarRadius, radarRadius);
 
         window.clear(sf::Color::Black);
 
-        // Building grid;
-        for(int y = 0; y < gRows; ++y)
-        {
-            for(int x = 0; x < gCols; ++x)
-            {
-                int index = y * gCols + x;
-                float rotationAngle = rotationAngles[index];
-
-                sf::Vector2f cellCenter(4 + (sW / gCols) * x, 4 + (sH / gRows) * y);
+        if (gridLayerReady)
+            gridLayer.Draw(window, frame.focusDegree);
 
-                DrawGridInstance(gridShape, cellCenter, rotationAngle + focusDegree);
-                window.draw(gridShape);
-            }
-        }
+        std::chrono::steady_clock::time_point particleStart = std::chrono::steady_clock::now();
+        particles.Update(deltaTime, particleVertices);
+        float particleMs = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - particleStart).count();
+        window.draw(particleVertices);
 
         // Screen text insert
         mousePosText.setString("Mouse Position: x = " + std::to_string(mousePos.x) + " y = " + std::to_string(mousePos.y));
-        fpsText.setString("FPS: " + std::to_string(fpsVal));
+        fpsText.setString("FPS: " + std::to_string(fpsVal) + "\nSim: " + std::to_string(frame.simMs) + " ms" +
+                          "\nGrid: " + std::to_string(gridLayer.GetCacheHits()) + " hits / " + std::to_string(gridLayer.GetRerenders()) + " renders" +
+                          "\nParticles: " + std::to_string(particles.GetCount()) + ", " + std::to_string(particleMs) + " ms on " +
+                          std::to_string(particles.GetThreadCount()) + " threads" +
+                          "\nSA mem: " + std::to_string(SteamAudioManager::GetDefaultAllocator().GetStats().liveBytes / 1024) + " KiB" +
+                          "\nQuality: " + std::to_string(governor.GetLevelIndex()) + (pinnedQuality < 0 ? " auto" : " pinned") +
+                          ", audio " + std::to_string(static_cast<int>(audioLoad * 100.f)) + "%");
 
         // Main actor position change
-        circleShape.setPosition(ballPos);
         radarCircle.setPosition(ballPos);
 
         // Sfml draw calls
         window.draw(focusShape);
+        window.draw(occluderShape);
         window.draw(radarCircle);
-        window.draw(circleShape);
+        window.draw(actorVertices);
         window.draw(mousePosText);
         window.draw(fpsText);
 
+        // Work up to here counts against the budget, display may sleep for the frame limit
+        float workSeconds = std::chrono::duration<float>(std::chrono::steady_clock::now() - frameStart).count();
         window.display();
+
+        if (pinnedQuality < 0 && governor.AddFrame(deltaTime, workSeconds, audioLoad))
+        {
+            quality = governor.GetLevel();
+            std::cout << "Quality level " << governor.GetLevelIndex() << ": grid " << quality.gridReso << " px, "
+                      << quality.segments << " segments, " << quality.voiceCount << " voices, "
+                      << (quality.bilinearHrtf ? "bilinear" : "nearest") << " HRTF" << std::endl;
+
+            mixer->SetVoiceLimit(quality.voiceCount);
+            mixer->SetBilinearHrtf(quality.bilinearHrtf);
+            focusShape.resize(quality.segments);
+            if (quality.gridReso != gridReso)
+            {
+                gridReso = quality.gridReso;
+                gCols = sW / gridReso;
+                gRows = sH / gridReso;
+                fillFlowField();
+                gridLayerReady = gridLayer.Configure(rotationAngles, gCols, gRows, gridReso, {(unsigned)sW, (unsigned)sH});
+                if (!gridLayerReady)
+                    std::cerr << "Grid layer disabled at " << gridReso << " px." << std::endl;
+                particles.SetField(rotationAngles, gCols, gRows, (float)gridReso);
+            }
+        }
+    }
+
+    simRunning = false;
+    simThread.join();
+
+    // Reported while the output still gives a play position
+    if (latencyTest)
+    {
+        mixer->UpdateLatency();
+        mixer->ReportLatency(std::cout);
     }
+    mixer->Shutdown();
+    decodeService.ReportUnderruns(std::cout);
+    if (audioOutput && audioOutput->GetUnderruns() > 0)
+        std::cout << "Audio output underruns: " << audioOutput->GetUnderruns() << std::endl;
+    if (pinnedQuality < 0)
+        std::cout << "Quality governor: level " << governor.GetLevelIndex() << ", " << governor.GetDowngrades() << " steps down, "
+                  << governor.GetUpgrades() << " steps up" << std::endl;
+    if (mixer->GetDroppedEchoes() > 0)
+        std::cout << "Radar echoes dropped, queue full: " << mixer->GetDroppedEchoes() << std::endl;
 
     steamAudio.CleanUp();
+    std::cout << "Steam Audio memory: ";
+    SteamAudioManager::GetDefaultAllocator().Report(std::cout);
 
     return 0;
-}
\ No newline at end of file
+}
@@ -0,0 +1,32 @@
+//---------------------Read-only memory mapped file---------------------------
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+class MappedFile
+{
+public:
+    MappedFile();
+    ~MappedFile();
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    bool Open(const std::string& path);
+    void Close();
+
+    bool IsOpen() const { return data != nullptr; }
+    const std::uint8_t* Data() const { return data; }
+    std::size_t Size() const { return size; }
+
+private:
+    const std::uint8_t* data;
+    std::size_t size;
+
+#ifdef _WIN32
+    void* fileHandle;
+    void* mappingHandle;
+#endif
+};
@@ -0,0 +1,205 @@
+//---------------------2D occluder geometry and line of sight queries---------------------------
+#include "occlusion.h"
+#include <algorithm>
+#include <cmath>
+
+namespace
+{
+    // Below -60 dB the path counts as silent, no point walking further
+    const float minTransmission = 1e-3f;
+}
+
+void AddOccluderPolygon(std::vector<OccluderSegment>& segments, const std::vector<sf::Vector2f>& points, float transmission)
+{
+    for (std::size_t i = 0; i < points.size(); ++i)
+    {
+        segments.push_back({ points[i], points[(i + 1) % points.size()], transmission });
+    }
+}
+
+OccluderGrid::OccluderGrid() :
+    origin(0.f, 0.f),
+    cellSize(1.f),
+    invCellSize(1.f),
+    cols(0),
+    rows(0)
+{
+}
+
+void OccluderGrid::Build(const std::vector<OccluderSegment>& newSegments, sf::Vector2f worldMin, sf::Vector2f worldMax, float newCellSize)
+{
+    segments = newSegments;
+    origin = worldMin;
+    cellSize = newCellSize;
+    invCellSize = 1.f / newCellSize;
+    cols = std::max(1, static_cast<int>(std::ceil((worldMax.x - worldMin.x) * invCellSize)));
+    rows = std::max(1, static_cast<int>(std::ceil((worldMax.y - worldMin.y) * invCellSize)));
+
+    // Two passes, count per cell then scatter, so cell lists end up contiguous
+    std::vector<std::uint32_t> counts(cols * rows + 1, 0);
+    for (const OccluderSegment& segment : segments)
+    {
+        WalkCells(segment.a, segment.b, [&](int cell, float, float) { ++counts[cell]; return true; });
+    }
+
+    cellStart.assign(cols * rows + 1, 0);
+    for (int cell = 0; cell < cols * rows; ++cell)
+    {
+        cellStart[cell + 1] = cellStart[cell] + counts[cell];
+    }
+
+    std::size_t total = cellStart.back();
+    cellAx.resize(total);
+    cellAy.resize(total);
+    cellDx.resize(total);
+    cellDy.resize(total);
+    cellTransmission.resize(total);
+
+    std::vector<std::uint32_t> cursor(cellStart.begin(), cellStart.end() - 1);
+    for (const OccluderSegment& segment : segments)
+    {
+        WalkCells(segment.a, segment.b, [&](int cell, float, float) {
+            std::uint32_t slot = cursor[cell]++;
+            cellAx[slot] = segment.a.x;
+            cellAy[slot] = segment.a.y;
+            cellDx[slot] = segment.b.x - segment.a.x;
+            cellDy[slot] = segment.b.y - segment.a.y;
+            cellTransmission[slot] = segment.transmission;
+            return true;
+        });
+    }
+}
+
+void OccluderGrid::Query(sf::Vector2f listener, const sf::Vector2f* sources, std::size_t sourceCount, OcclusionResult* results) const
+{
+    for (std::size_t i = 0; i < sourceCount; ++i)
+    {
+        results[i] = Trace(listener, sources[i]);
+    }
+}
+
+OcclusionResult OccluderGrid::Trace(sf::Vector2f from, sf::Vector2f to) const
+{
+    OcclusionResult result = { 1.f, 1.f };
+
+    float rx = to.x - from.x;
+    float ry = to.y - from.y;
+    WalkCells(from, to, [&](int cell, float tEnter, float tExit) {
+        float transmission = 1.f;
+        int hits = 0;
+
+        // Branch free so the compiler can vectorize the cell loop
+        for (std::uint32_t i = cellStart[cell]; i < cellStart[cell + 1]; ++i)
+        {
+            float sx = cellDx[i];
+            float sy = cellDy[i];
+            float denom = rx * sy - ry * sx;
+            float qpx = cellAx[i] - from.x;
+            float qpy = cellAy[i] - from.y;
+            float tNum = qpx * sy - qpy * sx;
+            float uNum = qpx * ry - qpy * rx;
+
+            float sign = denom < 0.f ? -1.f : 1.f;
+            denom *= sign;
+            tNum *= sign;
+            uNum *= sign;
+
+            // Segments spanning several cells are stored in each, a crossing only counts
+            // in the cell whose part of the ray [tEnter, tExit) contains the hit
+            bool hit = denom > 0.f &&
+                       tNum >= tEnter * denom && tNum < tExit * denom &&
+                       uNum >= 0.f && uNum <= denom;
+            transmission *= hit ? cellTransmission[i] : 1.f;
+            hits += hit;
+        }
+
+        if (hits > 0)
+        {
+            result.occlusion = 0.f;
+            result.transmission *= transmission;
+        }
+
+        if (result.transmission > minTransmission)
+            return true;
+
+        result.transmission = 0.f;
+        return false;
+    });
+
+    return result;
+}
+
+// Grid traversal (Amanatides & Woo), the segment is clipped to the grid bounds
+template <typename Visitor>
+void OccluderGrid::WalkCells(sf::Vector2f from, sf::Vector2f to, Visitor&& visit) const
+{
+    sf::Vector2f start = (from - origin) * invCellSize;
+    sf::Vector2f end = (to - origin) * invCellSize;
+    sf::Vector2f delta = end - start;
+
+    // Clip against [0, cols] x [0, rows]
+    float tMin = 0.f;
+    float tMax = 1.f;
+    const float startValues[2] = { start.x, start.y };
+    const float deltaValues[2] = { delta.x, delta.y };
+    const float limits[2] = { static_cast<float>(cols), static_cast<float>(rows) };
+    for (int axis = 0; axis < 2; ++axis)
+    {
+        if (deltaValues[axis] == 0.f)
+        {
+            if (startValues[axis] < 0.f || startValues[axis] > limits[axis])
+                return;
+            continue;
+        }
+        float t0 = (0.f - startValues[axis]) / deltaValues[axis];
+        float t1 = (limits[axis] - startValues[axis]) / deltaValues[axis];
+        if (t0 > t1)
+            std::swap(t0, t1);
+        tMin = std::max(tMin, t0);
+        tMax = std::min(tMax, t1);
+    }
+    if (tMin > tMax)
+        return;
+
+    sf::Vector2f clippedStart = start + delta * tMin;
+    int x = std::min(std::max(static_cast<int>(clippedStart.x), 0), cols - 1);
+    int y = std::min(std::max(static_cast<int>(clippedStart.y), 0), rows - 1);
+    sf::Vector2f clippedEnd = start + delta * tMax;
+    int endX = std::min(std::max(static_cast<int>(clippedEnd.x), 0), cols - 1);
+    int endY = std::min(std::max(static_cast<int>(clippedEnd.y), 0), rows - 1);
+
+    int stepX = delta.x > 0.f ? 1 : -1;
+    int stepY = delta.y > 0.f ? 1 : -1;
+    float tDeltaX = delta.x != 0.f ? std::abs(1.f / delta.x) : INFINITY;
+    float tDeltaY = delta.y != 0.f ? std::abs(1.f / delta.y) : INFINITY;
+    float tMaxX = delta.x != 0.f ? ((stepX > 0 ? x + 1 - start.x : start.x - x) * tDeltaX) : INFINITY;
+    float tMaxY = delta.y != 0.f ? ((stepY > 0 ? y + 1 - start.y : start.y - y) * tDeltaY) : INFINITY;
+
+    // The last cell owns t == 1 as well, so a hit at the very end still counts
+    float tEnter = tMin;
+    int maxSteps = std::abs(endX - x) + std::abs(endY - y);
+    for (int stepCount = 0; stepCount <= maxSteps; ++stepCount)
+    {
+        bool lastCell = (x == endX && y == endY) || stepCount == maxSteps;
+        float tExit = lastCell ? std::nextafter(tMax, INFINITY) : std::min(std::min(tMaxX, tMaxY), tMax);
+
+        if (!visit(y * cols + x, tEnter, tExit))
+            return;
+        if (lastCell)
+            return;
+
+        tEnter = tExit;
+        if (tMaxX < tMaxY)
+        {
+            x += stepX;
+            tMaxX += tDeltaX;
+        }
+        else
+        {
+            y += stepY;
+            tMaxY += tDeltaY;
+        }
+        if (x < 0 || x >= cols || y < 0 || y >= rows)
+            return;
+    }
+}
@@ -0,0 +1,63 @@
+//---------------------2D occluder geometry and line of sight queries---------------------------
+#pragma once
+
+#include <SFML/System/Vector2.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Wall piece, transmission is the fraction of sound passing through it
+struct OccluderSegment
+{
+    sf::Vector2f a;
+    sf::Vector2f b;
+    float transmission;
+};
+
+// Matches the Steam Audio direct effect parameters, occlusion 1 means fully visible
+struct OcclusionResult
+{
+    float occlusion;
+    float transmission;
+};
+
+// Closed polygon helper for building walls out of a point list
+void AddOccluderPolygon(std::vector<OccluderSegment>& segments, const std::vector<sf::Vector2f>& points, float transmission);
+
+// Static uniform grid over the occluder segments. Every cell keeps its own copy of the
+// segments it touches, a crossing only counts in the cell the ray is in at the hit.
+class OccluderGrid
+{
+public:
+    OccluderGrid();
+
+    void Build(const std::vector<OccluderSegment>& segments, sf::Vector2f worldMin, sf::Vector2f worldMax, float cellSize);
+
+    // One listener against many sources, results has to hold sourceCount entries
+    void Query(sf::Vector2f listener, const sf::Vector2f* sources, std::size_t sourceCount, OcclusionResult* results) const;
+
+    const std::vector<OccluderSegment>& GetSegments() const { return segments; }
+
+private:
+    template <typename Visitor>
+    void WalkCells(sf::Vector2f from, sf::Vector2f to, Visitor&& visit) const;
+
+    OcclusionResult Trace(sf::Vector2f from, sf::Vector2f to) const;
+
+    std::vector<OccluderSegment> segments;
+
+    // Cell contents in compressed rows, cellStart has one extra entry at the end.
+    // Segment data is laid out per cell so a cell visit reads contiguous memory.
+    std::vector<std::uint32_t> cellStart;
+    std::vector<float> cellAx;
+    std::vector<float> cellAy;
+    std::vector<float> cellDx;
+    std::vector<float> cellDy;
+    std::vector<float> cellTransmission;
+
+    sf::Vector2f origin;
+    float cellSize;
+    float invCellSize;
+    int cols;
+    int rows;
+};
@@ -0,0 +1,373 @@
+//---------------------Particles advected through the flow field---------------------------
+#include "particlefield.h"
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#define PARTICLES_LANES 8
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define PARTICLES_SSE2 1
+#define PARTICLES_LANES 4
+#else
+#define PARTICLES_LANES 1
+#endif
+
+namespace
+{
+    const float degToRad {3.14159265358979323846f / 180.f};
+
+    // A long frame would carry particles across several cells without sampling them
+    const float maxStepSeconds = 0.1f;
+    // Velocity covers this share of the gap to the local flow per second
+    const float responseRate = 4.f;
+    // Particles pile up where the field converges, each one is moved to a random spot this often
+    const float lifetimeSeconds = 6.f;
+
+    const sf::Color particleColor(150, 200, 255, 70);
+}
+
+ParticleField::ParticleField(int threadCount) :
+    cols(0),
+    rows(0),
+    invCellSize(0.f),
+    speed(60.f),
+    respawnCursor(0),
+    respawnCarry(0.f),
+    stepSeconds(0.f),
+    blend(0.f),
+    vertexOut(nullptr),
+    generation(0),
+    pendingSlices(0),
+    running(true)
+{
+    if (threadCount <= 0)
+        threadCount = static_cast<int>(std::min(8u, std::max(1u, std::thread::hardware_concurrency())));
+
+    for (int i = 1; i < threadCount; ++i)
+    {
+        workers.emplace_back(&ParticleField::WorkerLoop, this, i);
+    }
+}
+
+ParticleField::~ParticleField()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        running = false;
+    }
+    wake.notify_all();
+    for (std::thread& worker : workers)
+    {
+        worker.join();
+    }
+}
+
+void ParticleField::Reset(std::size_t count, sf::Vector2f newWorldSize, unsigned seed)
+{
+    worldSize = newWorldSize;
+    rng.seed(seed);
+    std::uniform_real_distribution<float> unitDistribution(0.f, 1.f);
+
+    posX.resize(count);
+    posY.resize(count);
+    velX.assign(count, 0.f);
+    velY.assign(count, 0.f);
+    for (std::size_t i = 0; i < count; ++i)
+    {
+        posX[i] = unitDistribution(rng) * worldSize.x;
+        posY[i] = unitDistribution(rng) * worldSize.y;
+    }
+    respawnCursor = 0;
+    respawnCarry = 0.f;
+}
+
+bool ParticleField::SetField(const std::vector<float>& rotationAngles, int newCols, int newRows, float cellSize)
+{
+    if (newCols < 2 || newRows < 2 || cellSize <= 0.f || rotationAngles.size() < std::size_t(newCols) * newRows)
+    {
+        std::cerr << "Particle field needs at least 2 x 2 cells." << std::endl;
+        return false;
+    }
+
+    cols = newCols;
+    rows = newRows;
+    invCellSize = 1.f / cellSize;
+    flowX.resize(std::size_t(cols) * rows);
+    flowY.resize(std::size_t(cols) * rows);
+    for (std::size_t i = 0; i < flowX.size(); ++i)
+    {
+        flowX[i] = std::cos(rotationAngles[i] * degToRad);
+        flowY[i] = std::sin(rotationAngles[i] * degToRad);
+    }
+    return true;
+}
+
+void ParticleField::Update(float deltaTime, sf::VertexArray& vertices)
+{
+    if (vertices.getVertexCount() != posX.size())
+    {
+        vertices.setPrimitiveType(sf::PrimitiveType::Points);
+        vertices.resize(posX.size());
+        for (std::size_t i = 0; i < posX.size(); ++i)
+        {
+            vertices[i].color = particleColor;
+        }
+    }
+    if (posX.empty() || flowX.empty())
+        return;
+
+    stepSeconds = std::min(std::max(deltaTime, 0.f), maxStepSeconds);
+    blend = std::min(1.f, stepSeconds * responseRate);
+    vertexOut = &vertices[0];
+    Respawn(stepSeconds);
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        pendingSlices = static_cast<int>(workers.size());
+        ++generation;
+    }
+    wake.notify_all();
+
+    RunSlice(0);
+
+    std::unique_lock<std::mutex> lock(mutex);
+    done.wait(lock, [this]() { return pendingSlices == 0; });
+}
+
+void ParticleField::WorkerLoop(int slice)
+{
+    std::uint64_t seenGeneration = 0;
+    while (true)
+    {
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            wake.wait(lock, [&]() { return !running || generation != seenGeneration; });
+            if (!running)
+                return;
+            seenGeneration = generation;
+        }
+
+        RunSlice(slice);
+
+        std::lock_guard<std::mutex> lock(mutex);
+        if (--pendingSlices == 0)
+            done.notify_one();
+    }
+}
+
+// Slices are whole SIMD batches so only the last one has a scalar tail
+void ParticleField::RunSlice(int slice)
+{
+    const std::size_t count = posX.size();
+    const std::size_t sliceCount = workers.size() + 1;
+    std::size_t perSlice = (count + sliceCount - 1) / sliceCount;
+    perSlice = (perSlice + PARTICLES_LANES - 1) / PARTICLES_LANES * PARTICLES_LANES;
+
+    std::size_t begin = std::min(count, perSlice * slice);
+    std::size_t end = std::min(count, begin + perSlice);
+    if (begin < end)
+        Advance(begin, end);
+}
+
+// Each particle eases its velocity toward the bilinear flow at its position, moves, and wraps
+// around the world edges. The field is sampled between cell centres and clamped at the border.
+void ParticleField::Advance(std::size_t begin, std::size_t end)
+{
+    const float maxGridX = cols - 1.001f;
+    const float maxGridY = rows - 1.001f;
+    std::size_t i = begin;
+
+#if defined(__AVX2__)
+    const __m256 invCell = _mm256_set1_ps(invCellSize);
+    const __m256 half = _mm256_set1_ps(0.5f);
+    const __m256 zero = _mm256_setzero_ps();
+    const __m256 maxX = _mm256_set1_ps(maxGridX);
+    const __m256 maxY = _mm256_set1_ps(maxGridY);
+    const __m256i colsVec = _mm256_set1_epi32(cols);
+    const __m256i one = _mm256_set1_epi32(1);
+    const __m256 speedVec = _mm256_set1_ps(speed);
+    const __m256 blendVec = _mm256_set1_ps(blend);
+    const __m256 dt = _mm256_set1_ps(stepSeconds);
+    const __m256 width = _mm256_set1_ps(worldSize.x);
+    const __m256 height = _mm256_set1_ps(worldSize.y);
+
+    for (; i + 8 <= end; i += 8)
+    {
+        __m256 x = _mm256_loadu_ps(&posX[i]);
+        __m256 y = _mm256_loadu_ps(&posY[i]);
+
+        __m256 gx = _mm256_min_ps(_mm256_max_ps(_mm256_sub_ps(_mm256_mul_ps(x, invCell), half), zero), maxX);
+        __m256 gy = _mm256_min_ps(_mm256_max_ps(_mm256_sub_ps(_mm256_mul_ps(y, invCell), half), zero), maxY);
+        __m256i ix = _mm256_cvttps_epi32(gx);
+        __m256i iy = _mm256_cvttps_epi32(gy);
+        __m256 fx = _mm256_sub_ps(gx, _mm256_cvtepi32_ps(ix));
+        __m256 fy = _mm256_sub_ps(gy, _mm256_cvtepi32_ps(iy));
+
+        __m256i i00 = _mm256_add_epi32(_mm256_mullo_epi32(iy, colsVec), ix);
+        __m256i i10 = _mm256_add_epi32(i00, one);
+        __m256i i01 = _mm256_add_epi32(i00, colsVec);
+        __m256i i11 = _mm256_add_epi32(i01, one);
+
+        __m256 ax = _mm256_i32gather_ps(flowX.data(), i00, 4);
+        __m256 bx = _mm256_i32gather_ps(flowX.data(), i10, 4);
+        __m256 cx = _mm256_i32gather_ps(flowX.data(), i01, 4);
+        __m256 dx = _mm256_i32gather_ps(flowX.data(), i11, 4);
+        __m256 ay = _mm256_i32gather_ps(flowY.data(), i00, 4);
+        __m256 by = _mm256_i32gather_ps(flowY.data(), i10, 4);
+        __m256 cy = _mm256_i32gather_ps(flowY.data(), i01, 4);
+        __m256 dy = _mm256_i32gather_ps(flowY.data(), i11, 4);
+
+        __m256 topX = _mm256_add_ps(ax, _mm256_mul_ps(_mm256_sub_ps(bx, ax), fx));
+        __m256 bottomX = _mm256_add_ps(cx, _mm256_mul_ps(_mm256_sub_ps(dx, cx), fx));
+        __m256 topY = _mm256_add_ps(ay, _mm256_mul_ps(_mm256_sub_ps(by, ay), fx));
+        __m256 bottomY = _mm256_add_ps(cy, _mm256_mul_ps(_mm256_sub_ps(dy, cy), fx));
+        __m256 targetX = _mm256_mul_ps(_mm256_add_ps(topX, _mm256_mul_ps(_mm256_sub_ps(bottomX, topX), fy)), speedVec);
+        __m256 targetY = _mm256_mul_ps(_mm256_add_ps(topY, _mm256_mul_ps(_mm256_sub_ps(bottomY, topY), fy)), speedVec);
+
+        __m256 vx = _mm256_loadu_ps(&velX[i]);
+        __m256 vy = _mm256_loadu_ps(&velY[i]);
+        vx = _mm256_add_ps(vx, _mm256_mul_ps(_mm256_sub_ps(targetX, vx), blendVec));
+        vy = _mm256_add_ps(vy, _mm256_mul_ps(_mm256_sub_ps(targetY, vy), blendVec));
+        x = _mm256_add_ps(x, _mm256_mul_ps(vx, dt));
+        y = _mm256_add_ps(y, _mm256_mul_ps(vy, dt));
+
+        // One step moves less than a world width, a single add or subtract wraps it
+        x = _mm256_add_ps(x, _mm256_and_ps(_mm256_cmp_ps(x, zero, _CMP_LT_OQ), width));
+        x = _mm256_sub_ps(x, _mm256_and_ps(_mm256_cmp_ps(x, width, _CMP_GE_OQ), width));
+        y = _mm256_add_ps(y, _mm256_and_ps(_mm256_cmp_ps(y, zero, _CMP_LT_OQ), height));
+        y = _mm256_sub_ps(y, _mm256_and_ps(_mm256_cmp_ps(y, height, _CMP_GE_OQ), height));
+
+        _mm256_storeu_ps(&velX[i], vx);
+        _mm256_storeu_ps(&velY[i], vy);
+        _mm256_storeu_ps(&posX[i], x);
+        _mm256_storeu_ps(&posY[i], y);
+    }
+#elif defined(PARTICLES_SSE2)
+    const __m128 invCell = _mm_set1_ps(invCellSize);
+    const __m128 half = _mm_set1_ps(0.5f);
+    const __m128 zero = _mm_setzero_ps();
+    const __m128 maxX = _mm_set1_ps(maxGridX);
+    const __m128 maxY = _mm_set1_ps(maxGridY);
+    const __m128 speedVec = _mm_set1_ps(speed);
+    const __m128 blendVec = _mm_set1_ps(blend);
+    const __m128 dt = _mm_set1_ps(stepSeconds);
+    const __m128 width = _mm_set1_ps(worldSize.x);
+    const __m128 height = _mm_set1_ps(worldSize.y);
+    const float* fieldX = flowX.data();
+    const float* fieldY = flowY.data();
+
+    for (; i + 4 <= end; i += 4)
+    {
+        __m128 x = _mm_loadu_ps(&posX[i]);
+        __m128 y = _mm_loadu_ps(&posY[i]);
+
+        __m128 gx = _mm_min_ps(_mm_max_ps(_mm_sub_ps(_mm_mul_ps(x, invCell), half), zero), maxX);
+        __m128 gy = _mm_min_ps(_mm_max_ps(_mm_sub_ps(_mm_mul_ps(y, invCell), half), zero), maxY);
+        __m128i ix = _mm_cvttps_epi32(gx);
+        __m128i iy = _mm_cvttps_epi32(gy);
+        __m128 fx = _mm_sub_ps(gx, _mm_cvtepi32_ps(ix));
+        __m128 fy = _mm_sub_ps(gy, _mm_cvtepi32_ps(iy));
+
+        // SSE2 has no gather or 32 bit multiply, the cell lookups are scalar and the blend stays vectorized
+        alignas(16) std::int32_t cellX[4];
+        alignas(16) std::int32_t cellY[4];
+        _mm_store_si128(reinterpret_cast<__m128i*>(cellX), ix);
+        _mm_store_si128(reinterpret_cast<__m128i*>(cellY), iy);
+        std::size_t c[4];
+        for (int k = 0; k < 4; ++k)
+        {
+            c[k] = std::size_t(cellY[k]) * cols + cellX[k];
+        }
+
+        __m128 ax = _mm_setr_ps(fieldX[c[0]], fieldX[c[1]], fieldX[c[2]], fieldX[c[3]]);
+        __m128 bx = _mm_setr_ps(fieldX[c[0] + 1], fieldX[c[1] + 1], fieldX[c[2] + 1], fieldX[c[3] + 1]);
+        __m128 cx = _mm_setr_ps(fieldX[c[0] + cols], fieldX[c[1] + cols], fieldX[c[2] + cols], fieldX[c[3] + cols]);
+        __m128 dx = _mm_setr_ps(fieldX[c[0] + cols + 1], fieldX[c[1] + cols + 1], fieldX[c[2] + cols + 1], fieldX[c[3] + cols + 1]);
+        __m128 ay = _mm_setr_ps(fieldY[c[0]], fieldY[c[1]], fieldY[c[2]], fieldY[c[3]]);
+        __m128 by = _mm_setr_ps(fieldY[c[0] + 1], fieldY[c[1] + 1], fieldY[c[2] + 1], fieldY[c[3] + 1]);
+        __m128 cy = _mm_setr_ps(fieldY[c[0] + cols], fieldY[c[1] + cols], fieldY[c[2] + cols], fieldY[c[3] + cols]);
+        __m128 dy = _mm_setr_ps(fieldY[c[0] + cols + 1], fieldY[c[1] + cols + 1], fieldY[c[2] + cols + 1], fieldY[c[3] + cols + 1]);
+
+        __m128 topX = _mm_add_ps(ax, _mm_mul_ps(_mm_sub_ps(bx, ax), fx));
+        __m128 bottomX = _mm_add_ps(cx, _mm_mul_ps(_mm_sub_ps(dx, cx), fx));
+        __m128 topY = _mm_add_ps(ay, _mm_mul_ps(_mm_sub_ps(by, ay), fx));
+        __m128 bottomY = _mm_add_ps(cy, _mm_mul_ps(_mm_sub_ps(dy, cy), fx));
+        __m128 targetX = _mm_mul_ps(_mm_add_ps(topX, _mm_mul_ps(_mm_sub_ps(bottomX, topX), fy)), speedVec);
+        __m128 targetY = _mm_mul_ps(_mm_add_ps(topY, _mm_mul_ps(_mm_sub_ps(bottomY, topY), fy)), speedVec);
+
+        __m128 vx = _mm_loadu_ps(&velX[i]);
+        __m128 vy = _mm_loadu_ps(&velY[i]);
+        vx = _mm_add_ps(vx, _mm_mul_ps(_mm_sub_ps(targetX, vx), blendVec));
+        vy = _mm_add_ps(vy, _mm_mul_ps(_mm_sub_ps(targetY, vy), blendVec));
+        x = _mm_add_ps(x, _mm_mul_ps(vx, dt));
+        y = _mm_add_ps(y, _mm_mul_ps(vy, dt));
+
+        // One step moves less than a world width, a single add or subtract wraps it
+        x = _mm_add_ps(x, _mm_and_ps(_mm_cmplt_ps(x, zero), width));
+        x = _mm_sub_ps(x, _mm_and_ps(_mm_cmpge_ps(x, width), width));
+        y = _mm_add_ps(y, _mm_and_ps(_mm_cmplt_ps(y, zero), height));
+        y = _mm_sub_ps(y, _mm_and_ps(_mm_cmpge_ps(y, height), height));
+
+        _mm_storeu_ps(&velX[i], vx);
+        _mm_storeu_ps(&velY[i], vy);
+        _mm_storeu_ps(&posX[i], x);
+        _mm_storeu_ps(&posY[i], y);
+    }
+#endif
+
+    for (; i < end; ++i)
+    {
+        float gx = std::min(std::max(posX[i] * invCellSize - 0.5f, 0.f), maxGridX);
+        float gy = std::min(std::max(posY[i] * invCellSize - 0.5f, 0.f), maxGridY);
+        int ix = static_cast<int>(gx);
+        int iy = static_cast<int>(gy);
+        float fx = gx - ix;
+        float fy = gy - iy;
+        std::size_t c = std::size_t(iy) * cols + ix;
+
+        float topX = flowX[c] + (flowX[c + 1] - flowX[c]) * fx;
+        float bottomX = flowX[c + cols] + (flowX[c + cols + 1] - flowX[c + cols]) * fx;
+        float topY = flowY[c] + (flowY[c + 1] - flowY[c]) * fx;
+        float bottomY = flowY[c + cols] + (flowY[c + cols + 1] - flowY[c + cols]) * fx;
+        float targetX = (topX + (bottomX - topX) * fy) * speed;
+        float targetY = (topY + (bottomY - topY) * fy) * speed;
+
+        velX[i] += (targetX - velX[i]) * blend;
+        velY[i] += (targetY - velY[i]) * blend;
+        float x = posX[i] + velX[i] * stepSeconds;
+        float y = posY[i] + velY[i] * stepSeconds;
+        x += x < 0.f ? worldSize.x : 0.f;
+        x -= x >= worldSize.x ? worldSize.x : 0.f;
+        y += y < 0.f ? worldSize.y : 0.f;
+        y -= y >= worldSize.y ? worldSize.y : 0.f;
+        posX[i] = x;
+        posY[i] = y;
+    }
+
+    // The vertex array is interleaved, the slice writes its own range while it is still in cache
+    for (std::size_t v = begin; v < end; ++v)
+    {
+        vertexOut[v].position = sf::Vector2f(posX[v], posY[v]);
+    }
+}
+
+// Round robin over the particles, a fixed share per second so each lives about lifetimeSeconds
+void ParticleField::Respawn(float deltaTime)
+{
+    std::uniform_real_distribution<float> unitDistribution(0.f, 1.f);
+    respawnCarry += posX.size() * deltaTime / lifetimeSeconds;
+    std::size_t respawnCount = std::min(posX.size(), static_cast<std::size_t>(respawnCarry));
+    respawnCarry -= respawnCount;
+
+    for (std::size_t n = 0; n < respawnCount; ++n)
+    {
+        posX[respawnCursor] = unitDistribution(rng) * worldSize.x;
+        posY[respawnCursor] = unitDistribution(rng) * worldSize.y;
+        velX[respawnCursor] = 0.f;
+        velY[respawnCursor] = 0.f;
+        respawnCursor = (respawnCursor + 1) % posX.size();
+    }
+}
@@ -0,0 +1,186 @@
+//---------------------Tracked pool allocator for Steam Audio's internal memory---------------------------
+#include "poolallocator.h"
+#include <iostream>
+#include <new>
+
+namespace
+{
+    // Size classes 64 B .. 64 KiB, every pooled block is cache line aligned
+    const std::size_t minClassSize = 64;
+    const int classCount = 11;
+    const std::size_t poolAlignment = 64;
+    const std::size_t chunkSize = 1 << 20;
+
+    std::size_t ClassBytes(int sizeClass)
+    {
+        return minClassSize << sizeClass;
+    }
+
+    void* HeapAllocate(std::size_t size, std::size_t alignment)
+    {
+        return ::operator new(size, std::align_val_t(alignment), std::nothrow);
+    }
+
+    void HeapFree(void* block, std::size_t alignment)
+    {
+        ::operator delete(block, std::align_val_t(alignment));
+    }
+}
+
+PoolAllocator::PoolAllocator(std::size_t capBytes) :
+    capBytes(capBytes),
+    freeLists(classCount, nullptr),
+    chunkCursor(nullptr),
+    chunkRemaining(0)
+{
+}
+
+PoolAllocator::~PoolAllocator()
+{
+    if (!liveBlocks.empty())
+        std::cerr << "Pool allocator destroyed with " << liveBlocks.size() << " live blocks (" << stats.liveBytes << " bytes)" << std::endl;
+
+    for (const auto& entry : liveBlocks)
+    {
+        if (entry.second.sizeClass < 0)
+            HeapFree(entry.first, entry.second.alignment);
+    }
+    for (void* chunk : chunks)
+    {
+        HeapFree(chunk, poolAlignment);
+    }
+}
+
+void* PoolAllocator::Allocate(std::size_t size, std::size_t alignment)
+{
+    alignment = alignment < alignof(std::max_align_t) ? alignof(std::max_align_t) : alignment;
+
+    std::lock_guard<std::mutex> lock(mutex);
+    if (capBytes > 0 && stats.liveBytes + size > capBytes)
+    {
+        if (stats.failedAllocations++ == 0)
+            std::cerr << "Memory cap of " << capBytes << " bytes reached, allocation of " << size << " refused" << std::endl;
+        return nullptr;
+    }
+
+    int sizeClass = SizeClass(size, alignment);
+    void* block = nullptr;
+    if (sizeClass < 0)
+    {
+        block = HeapAllocate(size, alignment);
+        if (block)
+            stats.reservedBytes += size;
+    }
+    else if (freeLists[sizeClass])
+    {
+        // Free blocks keep the next pointer in their first bytes
+        block = freeLists[sizeClass];
+        freeLists[sizeClass] = *static_cast<void**>(block);
+    }
+    else
+    {
+        block = CarveFromArena(sizeClass);
+    }
+
+    if (!block)
+    {
+        ++stats.failedAllocations;
+        return nullptr;
+    }
+
+    liveBlocks[block] = { size, alignment, sizeClass };
+    stats.liveBytes += size;
+    stats.liveBlocks = liveBlocks.size();
+    stats.highWaterBytes = stats.liveBytes > stats.highWaterBytes ? stats.liveBytes : stats.highWaterBytes;
+    ++stats.allocations;
+    return block;
+}
+
+void PoolAllocator::Free(void* block)
+{
+    if (!block)
+        return;
+
+    std::lock_guard<std::mutex> lock(mutex);
+    auto entry = liveBlocks.find(block);
+    if (entry == liveBlocks.end())
+    {
+        std::cerr << "Pool allocator asked to free an unknown block " << block << std::endl;
+        return;
+    }
+
+    BlockInfo info = entry->second;
+    liveBlocks.erase(entry);
+    stats.liveBytes -= info.size;
+    stats.liveBlocks = liveBlocks.size();
+    ++stats.frees;
+
+    if (info.sizeClass < 0)
+    {
+        HeapFree(block, info.alignment);
+        stats.reservedBytes -= info.size;
+    }
+    else
+    {
+        *static_cast<void**>(block) = freeLists[info.sizeClass];
+        freeLists[info.sizeClass] = block;
+    }
+}
+
+void PoolAllocator::SetCap(std::size_t bytes)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    capBytes = bytes;
+}
+
+AllocatorStats PoolAllocator::GetStats() const
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    return stats;
+}
+
+void PoolAllocator::Report(std::ostream& out) const
+{
+    AllocatorStats snapshot = GetStats();
+    out << snapshot.liveBytes << " bytes live in " << snapshot.liveBlocks << " blocks, "
+        << snapshot.highWaterBytes << " high water, " << snapshot.reservedBytes << " reserved, "
+        << snapshot.allocations << " allocs / " << snapshot.frees << " frees";
+    if (snapshot.failedAllocations > 0)
+        out << ", " << snapshot.failedAllocations << " refused";
+    out << std::endl;
+}
+
+int PoolAllocator::SizeClass(std::size_t size, std::size_t alignment)
+{
+    if (alignment > poolAlignment)
+        return -1;
+
+    for (int sizeClass = 0; sizeClass < classCount; ++sizeClass)
+    {
+        if (size <= ClassBytes(sizeClass))
+            return sizeClass;
+    }
+    return -1;
+}
+
+void* PoolAllocator::CarveFromArena(int sizeClass)
+{
+    std::size_t bytes = ClassBytes(sizeClass);
+    if (chunkRemaining < bytes)
+    {
+        // The tail of the old chunk is given up, at most one largest class worth per chunk
+        void* chunk = HeapAllocate(chunkSize, poolAlignment);
+        if (!chunk)
+            return nullptr;
+        chunks.push_back(chunk);
+        chunkCursor = static_cast<unsigned char*>(chunk);
+        chunkRemaining = chunkSize;
+        stats.reservedBytes += chunkSize;
+    }
+
+    // Class sizes are multiples of 64 so the cursor stays aligned
+    void* block = chunkCursor;
+    chunkCursor += bytes;
+    chunkRemaining -= bytes;
+    return block;
+}
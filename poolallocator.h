@@ -0,0 +1,72 @@
+//---------------------Tracked pool allocator for Steam Audio's internal memory---------------------------
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <ostream>
+#include <unordered_map>
+#include <vector>
+
+// Anything Steam Audio can allocate through, see SteamAudioManager::SetAllocator
+class AudioAllocator
+{
+public:
+    virtual ~AudioAllocator() = default;
+    virtual void* Allocate(std::size_t size, std::size_t alignment) = 0;
+    virtual void Free(void* block) = 0;
+};
+
+struct AllocatorStats
+{
+    std::size_t liveBytes = 0;
+    std::size_t liveBlocks = 0;
+    std::size_t highWaterBytes = 0;
+    std::size_t reservedBytes = 0;
+    std::uint64_t allocations = 0;
+    std::uint64_t frees = 0;
+    std::uint64_t failedAllocations = 0;
+};
+
+// Small blocks come from power of two size classes carved out of large arena chunks and are
+// recycled through per-class free lists, big or over-aligned blocks go to the aligned heap.
+// Thread safe, every block is tracked so live bytes, high water and leaks are always known.
+class PoolAllocator : public AudioAllocator
+{
+public:
+    // capBytes 0 means unlimited
+    explicit PoolAllocator(std::size_t capBytes = 0);
+    ~PoolAllocator() override;
+
+    PoolAllocator(const PoolAllocator&) = delete;
+    PoolAllocator& operator=(const PoolAllocator&) = delete;
+
+    // Returns nullptr when the cap would be exceeded
+    void* Allocate(std::size_t size, std::size_t alignment) override;
+    void Free(void* block) override;
+
+    void SetCap(std::size_t bytes);
+    AllocatorStats GetStats() const;
+    void Report(std::ostream& out) const;
+
+private:
+    struct BlockInfo
+    {
+        std::size_t size;
+        std::size_t alignment;
+        int sizeClass;
+    };
+
+    static int SizeClass(std::size_t size, std::size_t alignment);
+    void* CarveFromArena(int sizeClass);
+
+    mutable std::mutex mutex;
+    std::size_t capBytes;
+    AllocatorStats stats;
+    std::unordered_map<void*, BlockInfo> liveBlocks;
+
+    std::vector<void*> freeLists;
+    std::vector<void*> chunks;
+    unsigned char* chunkCursor;
+    std::size_t chunkRemaining;
+};
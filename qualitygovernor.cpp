@@ -0,0 +1,106 @@
+//---------------------Adaptive quality from frame and audio deadlines---------------------------
+#include "qualitygovernor.h"
+#include <algorithm>
+
+namespace
+{
+    // Best first. Each step gives up a little on every knob so a single step is a real saving.
+    const QualityGovernor::Level levels[] = {
+        { 20, 100, 8, true },
+        { 20, 64, 8, false },
+        { 30, 48, 6, false },
+        { 40, 32, 4, false },
+        { 60, 16, 2, false },
+    };
+    const int levelCount = static_cast<int>(sizeof(levels) / sizeof(levels[0]));
+
+    const float windowLength = 0.5f;
+    // A frame this far over budget was visibly dropped
+    const float lateFactor = 1.15f;
+    const float maxLateFraction = 0.1f;
+    // Audio blocks past this share of their deadline are one hiccup away from an underrun
+    const float maxAudioLoad = 0.75f;
+    // Headroom needed before trying the next better level
+    const float calmWorkFraction = 0.5f;
+    const float calmAudioLoad = 0.4f;
+    const int minUpgradeWindows = 6;
+    const int maxUpgradeWindows = 96;
+    // A downgrade this soon after an upgrade means the better level did not hold
+    const int failedUpgradeWindows = 4;
+}
+
+QualityGovernor::QualityGovernor(float frameBudgetSeconds, int startLevel) :
+    frameBudget(frameBudgetSeconds),
+    level(std::max(0, std::min(levelCount - 1, startLevel))),
+    windowSeconds(0.f),
+    lateFrames(0),
+    audioPeak(0.f),
+    calmWindows(0),
+    upgradeWindows(minUpgradeWindows),
+    windowsSinceUpgrade(maxUpgradeWindows),
+    downgrades(0),
+    upgrades(0)
+{
+    workTimes.reserve(256);
+}
+
+int QualityGovernor::GetLevelCount() const
+{
+    return levelCount;
+}
+
+const QualityGovernor::Level& QualityGovernor::GetLevel(int index)
+{
+    return levels[std::max(0, std::min(levelCount - 1, index))];
+}
+
+bool QualityGovernor::AddFrame(float frameSeconds, float workSeconds, float audioLoad)
+{
+    windowSeconds += frameSeconds;
+    workTimes.push_back(workSeconds);
+    lateFrames += frameSeconds > frameBudget * lateFactor;
+    audioPeak = std::max(audioPeak, audioLoad);
+
+    if (windowSeconds < windowLength)
+        return false;
+
+    bool changed = Evaluate();
+    windowSeconds = 0.f;
+    workTimes.clear();
+    lateFrames = 0;
+    audioPeak = 0.f;
+    return changed;
+}
+
+bool QualityGovernor::Evaluate()
+{
+    ++windowsSinceUpgrade;
+
+    float lateFraction = float(lateFrames) / workTimes.size();
+    if (lateFraction > maxLateFraction || audioPeak > maxAudioLoad)
+    {
+        calmWindows = 0;
+        if (level == levelCount - 1)
+            return false;
+
+        if (windowsSinceUpgrade <= failedUpgradeWindows)
+            upgradeWindows = std::min(maxUpgradeWindows, upgradeWindows * 2);
+        ++level;
+        ++downgrades;
+        return true;
+    }
+
+    // The 90th percentile work time, a few slow frames should not block an upgrade
+    std::size_t index = workTimes.size() * 9 / 10;
+    std::nth_element(workTimes.begin(), workTimes.begin() + index, workTimes.end());
+    bool calm = lateFrames == 0 && workTimes[index] < frameBudget * calmWorkFraction && audioPeak < calmAudioLoad;
+    calmWindows = calm ? calmWindows + 1 : 0;
+    if (level == 0 || calmWindows < upgradeWindows)
+        return false;
+
+    --level;
+    ++upgrades;
+    calmWindows = 0;
+    windowsSinceUpgrade = 0;
+    return true;
+}
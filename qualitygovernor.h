@@ -0,0 +1,58 @@
+//---------------------Adaptive quality from frame and audio deadlines---------------------------
+#pragma once
+
+#include <vector>
+
+// Steps through a fixed ladder of quality levels, level 0 being the best. Frames are collected
+// into half second windows. A window with late frames or an audio block that used most of its
+// deadline drops one level straight away. Going back up takes several calm windows in a row with
+// clear headroom, and that count doubles whenever an upgrade is undone soon after, so the level
+// settles instead of bouncing between two neighbours.
+class QualityGovernor
+{
+public:
+    struct Level
+    {
+        // Pixels per background grid cell, larger means fewer cells
+        int gridReso;
+        // Vertices of the focus cone fan
+        int segments;
+        // Pulse voices the mixer may use at once
+        int voiceCount;
+        // Bilinear HRTF interpolation for pulses, streams and the focus buses, nearest otherwise
+        bool bilinearHrtf;
+    };
+
+    explicit QualityGovernor(float frameBudgetSeconds, int startLevel = 0);
+
+    // Once per rendered frame. frameSeconds is the full interval including the frame limiter,
+    // workSeconds the part spent before presenting, audioLoad the worst block time since the last
+    // call as a fraction of the block duration. Returns true when the level changed.
+    bool AddFrame(float frameSeconds, float workSeconds, float audioLoad);
+
+    int GetLevelIndex() const { return level; }
+    int GetLevelCount() const;
+    const Level& GetLevel() const { return GetLevel(level); }
+    static const Level& GetLevel(int index);
+
+    unsigned GetDowngrades() const { return downgrades; }
+    unsigned GetUpgrades() const { return upgrades; }
+
+private:
+    bool Evaluate();
+
+    float frameBudget;
+    int level;
+
+    float windowSeconds;
+    std::vector<float> workTimes;
+    int lateFrames;
+    float audioPeak;
+
+    int calmWindows;
+    int upgradeWindows;
+    int windowsSinceUpgrade;
+
+    unsigned downgrades;
+    unsigned upgrades;
+};
@@ -0,0 +1,155 @@
+//---------------------Polyphase windowed-sinc resampler---------------------------
+#include "resampler.h"
+#include <cmath>
+#include <numeric>
+
+#if defined(__AVX__)
+#include <immintrin.h>
+#elif defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1)
+#include <xmmintrin.h>
+#define RESAMPLER_SSE 1
+#endif
+
+namespace
+{
+    const double piVal = 3.14159265358979323846;
+
+    // taps is a multiple of 8
+    float Dot(const float* a, const float* b, int taps)
+    {
+#if defined(__AVX__)
+        __m256 sum = _mm256_setzero_ps();
+        for (int i = 0; i < taps; i += 8)
+        {
+            sum = _mm256_add_ps(sum, _mm256_mul_ps(_mm256_loadu_ps(a + i), _mm256_loadu_ps(b + i)));
+        }
+        __m128 half = _mm_add_ps(_mm256_castps256_ps128(sum), _mm256_extractf128_ps(sum, 1));
+        half = _mm_add_ps(half, _mm_movehl_ps(half, half));
+        half = _mm_add_ss(half, _mm_shuffle_ps(half, half, 1));
+        return _mm_cvtss_f32(half);
+#elif defined(RESAMPLER_SSE)
+        __m128 sum0 = _mm_setzero_ps();
+        __m128 sum1 = _mm_setzero_ps();
+        for (int i = 0; i < taps; i += 8)
+        {
+            sum0 = _mm_add_ps(sum0, _mm_mul_ps(_mm_loadu_ps(a + i), _mm_loadu_ps(b + i)));
+            sum1 = _mm_add_ps(sum1, _mm_mul_ps(_mm_loadu_ps(a + i + 4), _mm_loadu_ps(b + i + 4)));
+        }
+        __m128 sum = _mm_add_ps(sum0, sum1);
+        sum = _mm_add_ps(sum, _mm_movehl_ps(sum, sum));
+        sum = _mm_add_ss(sum, _mm_shuffle_ps(sum, sum, 1));
+        return _mm_cvtss_f32(sum);
+#else
+        float sum = 0.f;
+        for (int i = 0; i < taps; ++i)
+        {
+            sum += a[i] * b[i];
+        }
+        return sum;
+#endif
+    }
+}
+
+PolyphaseResampler::PolyphaseResampler(int inputRate, int outputRate, int tapsPerPhase) :
+    inputRate(inputRate),
+    outputRate(outputRate),
+    taps((tapsPerPhase + 7) / 8 * 8),
+    position(0),
+    discard(0)
+{
+    int divisor = std::gcd(inputRate, outputRate);
+    upFactor = outputRate / divisor;
+    downFactor = inputRate / divisor;
+
+    // Prototype low pass at the upsampled rate, cut below the lower of the two Nyquists
+    // Odd length so the centre tap sits on a whole upsampled step, the last slot stays zero
+    int length = upFactor * taps - 1;
+    double cutoff = 0.5 / upFactor * std::min(1.0, double(upFactor) / downFactor) * 0.95;
+    double center = (length - 1) * 0.5;
+    std::vector<double> prototype(upFactor * taps, 0.0);
+    for (int j = 0; j < length; ++j)
+    {
+        double x = j - center;
+        double sinc = x == 0.0 ? 2.0 * cutoff : std::sin(2.0 * piVal * cutoff * x) / (piVal * x);
+        double window = 0.42 - 0.5 * std::cos(2.0 * piVal * j / (length - 1)) + 0.08 * std::cos(4.0 * piVal * j / (length - 1));
+        prototype[j] = sinc * window * upFactor;
+    }
+
+    coefficients.resize(upFactor * taps);
+    for (int phase = 0; phase < upFactor; ++phase)
+    {
+        for (int k = 0; k < taps; ++k)
+        {
+            coefficients[phase * taps + (taps - 1 - k)] = static_cast<float>(prototype[phase + k * upFactor]);
+        }
+    }
+
+    Reset();
+}
+
+void PolyphaseResampler::Reset(bool compensateDelay)
+{
+    buffer.assign(taps - 1, 0.f);
+    position = 0;
+    discard = 0;
+    if (compensateDelay)
+    {
+        // Delay is the centre tap in upsampled steps: whole outputs are dropped, the rest offsets the start
+        std::size_t delay = static_cast<std::size_t>(upFactor) * taps / 2 - 1;
+        discard = delay / downFactor;
+        position = delay % downFactor;
+    }
+}
+
+std::size_t PolyphaseResampler::Process(const float* input, std::size_t inputCount, std::vector<float>& output)
+{
+    buffer.insert(buffer.end(), input, input + inputCount);
+
+    // position counts in 1/upFactor input samples, buffer[first .. first + taps) feeds one output
+    std::size_t produced = 0;
+    std::size_t first = position / upFactor;
+    output.reserve(output.size() + (inputCount * upFactor) / downFactor + 1);
+    while (first + taps <= buffer.size())
+    {
+        if (discard > 0)
+        {
+            --discard;
+        }
+        else
+        {
+            std::size_t phase = position % upFactor;
+            output.push_back(Dot(&coefficients[phase * taps], &buffer[first], taps));
+            ++produced;
+        }
+        position += downFactor;
+        first = position / upFactor;
+    }
+
+    // Keep the last taps - 1 samples as history for the next call
+    std::size_t drop = buffer.size() - (taps - 1);
+    buffer.erase(buffer.begin(), buffer.begin() + drop);
+    position -= drop * upFactor;
+    return produced;
+}
+
+std::vector<float> Resample(const std::vector<float>& input, int inputRate, int outputRate)
+{
+    if (inputRate == outputRate)
+        return input;
+
+    PolyphaseResampler resampler(inputRate, outputRate);
+    std::vector<float> output;
+    output.reserve(static_cast<std::size_t>(static_cast<unsigned long long>(input.size()) * outputRate / inputRate) + 64);
+    resampler.Process(input.data(), input.size(), output);
+
+    // Flush the tail still inside the filter with silence
+    std::vector<float> silence(64, 0.f);
+    std::size_t expected = static_cast<std::size_t>((static_cast<unsigned long long>(input.size()) * outputRate + inputRate - 1) / inputRate);
+    while (output.size() < expected)
+    {
+        resampler.Process(silence.data(), silence.size(), output);
+    }
+
+    output.resize(expected);
+    return output;
+}
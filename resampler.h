@@ -0,0 +1,40 @@
+//---------------------Polyphase windowed-sinc resampler---------------------------
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+// Rational L/M resampler, one short FIR per output phase so each output sample is a single
+// dot product (SSE/AVX when available). Streaming, keeps its own history between calls.
+class PolyphaseResampler
+{
+public:
+    // tapsPerPhase is rounded up to a multiple of 8 to keep the SIMD loop free of tails
+    PolyphaseResampler(int inputRate, int outputRate, int tapsPerPhase = 32);
+
+    // Clears history; with compensateDelay the filter's group delay is skipped so output
+    // sample n lines up with input time n / outputRate
+    void Reset(bool compensateDelay = true);
+
+    // Appends the produced samples to output, returns how many were appended
+    std::size_t Process(const float* input, std::size_t inputCount, std::vector<float>& output);
+
+    int GetInputRate() const { return inputRate; }
+    int GetOutputRate() const { return outputRate; }
+
+private:
+    int inputRate;
+    int outputRate;
+    int upFactor;
+    int downFactor;
+    int taps;
+
+    // upFactor phases of taps coefficients each, reversed so they run forward over the input
+    std::vector<float> coefficients;
+    std::vector<float> buffer;
+    std::size_t position;
+    std::size_t discard;
+};
+
+// Whole clip conversion, output length is ceil(size * outputRate / inputRate)
+std::vector<float> Resample(const std::vector<float>& input, int inputRate, int outputRate);
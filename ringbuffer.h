@@ -0,0 +1,102 @@
+//---------------------Lock free single producer / single consumer ring buffer---------------------------
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <vector>
+
+// Capacity is rounded up to a power of two. One thread pushes, one thread pops,
+// neither ever blocks or allocates after construction.
+template <typename T>
+class SpscRing
+{
+public:
+    explicit SpscRing(std::size_t minCapacity)
+    {
+        std::size_t capacity = 1;
+        while (capacity < minCapacity)
+        {
+            capacity <<= 1;
+        }
+        items.resize(capacity);
+        mask = capacity - 1;
+    }
+
+    std::size_t Capacity() const { return items.size(); }
+
+    // Either side may call these, the answer is a snapshot
+    std::size_t Size() const
+    {
+        return writePos.load(std::memory_order_acquire) - readPos.load(std::memory_order_acquire);
+    }
+    std::size_t Free() const { return Capacity() - Size(); }
+
+    // Producer side
+    bool Push(const T& item)
+    {
+        std::size_t write = writePos.load(std::memory_order_relaxed);
+        if (write - readPos.load(std::memory_order_acquire) == items.size())
+            return false;
+
+        items[write & mask] = item;
+        writePos.store(write + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Writes as many items as fit, returns how many were written
+    std::size_t Write(const T* source, std::size_t count)
+    {
+        std::size_t write = writePos.load(std::memory_order_relaxed);
+        std::size_t available = items.size() - (write - readPos.load(std::memory_order_acquire));
+        count = std::min(count, available);
+
+        for (std::size_t i = 0; i < count; ++i)
+        {
+            items[(write + i) & mask] = source[i];
+        }
+        writePos.store(write + count, std::memory_order_release);
+        return count;
+    }
+
+    // Consumer side
+    bool Pop(T& item)
+    {
+        std::size_t read = readPos.load(std::memory_order_relaxed);
+        if (read == writePos.load(std::memory_order_acquire))
+            return false;
+
+        item = items[read & mask];
+        readPos.store(read + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Reads up to count items, returns how many were read
+    std::size_t Read(T* destination, std::size_t count)
+    {
+        std::size_t read = readPos.load(std::memory_order_relaxed);
+        std::size_t available = writePos.load(std::memory_order_acquire) - read;
+        count = std::min(count, available);
+
+        for (std::size_t i = 0; i < count; ++i)
+        {
+            destination[i] = items[(read + i) & mask];
+        }
+        readPos.store(read + count, std::memory_order_release);
+        return count;
+    }
+
+    // Consumer side, drops everything currently queued
+    void Clear()
+    {
+        readPos.store(writePos.load(std::memory_order_acquire), std::memory_order_release);
+    }
+
+private:
+    std::vector<T> items;
+    std::size_t mask;
+
+    // Kept on separate cache lines so producer and consumer do not false share
+    alignas(64) std::atomic<std::size_t> writePos{ 0 };
+    alignas(64) std::atomic<std::size_t> readPos{ 0 };
+};
@@ -0,0 +1,26 @@
+//---------------------PCM sample format conversion---------------------------
+#pragma once
+
+#include <SFML/Audio.hpp>
+#include <algorithm>
+#include <cstddef>
+
+// Plain loops on purpose, at -O2 both vectorize
+inline void Int16ToFloat(const sf::Int16* input, float* output, std::size_t count)
+{
+    const float scale = 1.f / 32767.f;
+    for (std::size_t i = 0; i < count; ++i)
+    {
+        output[i] = input[i] * scale;
+    }
+}
+
+// Clamps so an overdriven mix saturates instead of wrapping
+inline void FloatToInt16(const float* input, sf::Int16* output, std::size_t count)
+{
+    for (std::size_t i = 0; i < count; ++i)
+    {
+        float sample = std::max(-1.f, std::min(1.f, input[i]));
+        output[i] = static_cast<sf::Int16>(sample * 32767.f);
+    }
+}
@@ -0,0 +1,300 @@
+//---------------------Fixed timestep simulation producing immutable frame snapshots---------------------------
+#include "simulation.h"
+#include "fasttrig.h"
+#include <algorithm>
+#include <cmath>
+#include <random>
+
+namespace
+{
+    const float piVal {3.14159265358979323846f};
+    const float radarSpeed {1500.f};
+    const float maxRadarRadius {600.f};
+    const float minRadarRadius {10.f};
+    // World scale for propagation delay, the screen is about 100 m across
+    const float metersPerPixel {0.05f};
+
+    // Radar echoes, past the budget only a subset of the actors in reach answer a pulse
+    const std::size_t maxEchoesPerPulse {4096};
+    const float echoGain {0.1f};
+    const float focusEchoBoost {2.f};
+
+    // Wandering actors move at this speed per axis, the grid needs a bound on how far anyone moves
+    const float wanderSpeed {60.f};
+
+    // Focus shape limits
+    const float maxDistance {800.f};
+    const float maxRadius {1000.f};
+    const float minRadius {60.f};
+    const float minSectorWidth {5.0f * (piVal / 180.0f)};
+    const float maxSectorWidth {240.0f * (piVal / 180.0f)};
+}
+
+Simulation::Simulation(SpatialMixer& mixer, int actorCount, sf::Vector2f worldSize) :
+    mixer(mixer),
+    worldSize(worldSize),
+    focusHighlightColor(230, 60, 120),
+    focusGrid(worldSize),
+    stepCount(0),
+    timestep(0.f),
+    focusRadian(0.f),
+    outerRadius(200.f),
+    sectorWidth(0.f),
+    radarRadiusPrev(minRadarRadius),
+    radarRadius(minRadarRadius),
+    radarAlpha(0),
+    isRadarExpanding(false),
+    isRadarPending(false),
+    lastPulseCount(0),
+    lastRadarTriggers(0)
+{
+    // Actors, index 0 is the keyboard driven main actor and acts as the listener
+    sf::Color circleColor(100, 100, 100);
+    actors.Reserve(actorCount + 1);
+    echoBatch.reserve(maxEchoesPerPulse);
+    occlusionSources.reserve(actorCount + 1);
+    occlusionActors.reserve(actorCount);
+    occlusionResults.reserve(actorCount + 1);
+    playerIndex = actors.Add(worldSize * 0.5f, {0.f, 0.f}, 20.f, circleColor, ActorEmitting);
+
+    std::mt19937 actorRng(42);
+    std::uniform_real_distribution<float> randX(0.f, worldSize.x);
+    std::uniform_real_distribution<float> randY(0.f, worldSize.y);
+    std::uniform_real_distribution<float> randVelocity(-wanderSpeed, wanderSpeed);
+    std::uniform_int_distribution<int> randShade(60, 180);
+    for (int i = 0; i < actorCount; ++i)
+    {
+        int shade = randShade(actorRng);
+        actors.Add({randX(actorRng), randY(actorRng)}, {randVelocity(actorRng), randVelocity(actorRng)}, 4.f,
+                   sf::Color(shade / 2, shade, 255 - shade / 2), (i % 4 == 0) ? ActorEmitting : ActorSilent);
+    }
+    prevX = actors.posX;
+    prevY = actors.posY;
+    listenerPrev = actors.GetPosition(playerIndex);
+    mousePos = listenerPrev;
+
+    // Occluder walls, transmission is how much sound leaks through each wall
+    std::vector<OccluderSegment> occluders;
+    AddOccluderPolygon(occluders, {{300.f, 200.f}, {700.f, 200.f}, {700.f, 260.f}, {300.f, 260.f}}, 0.3f);
+    AddOccluderPolygon(occluders, {{1300.f, 350.f}, {1360.f, 350.f}, {1360.f, 850.f}, {1300.f, 850.f}}, 0.1f);
+    AddOccluderPolygon(occluders, {{450.f, 700.f}, {650.f, 650.f}, {750.f, 850.f}, {500.f, 900.f}}, 0.5f);
+    occluderGrid.Build(occluders, {0.f, 0.f}, worldSize, 24.f);
+
+    stepTime = std::chrono::steady_clock::now();
+}
+
+void Simulation::Step(float deltaTime, const InputState& input)
+{
+    prevX = actors.posX;
+    prevY = actors.posY;
+    radarRadiusPrev = radarRadius;
+
+    sf::Vector2f ballPos = actors.GetPosition(playerIndex);
+    listenerPrev = ballPos;
+    mousePos = input.mousePos;
+
+    // Line of sight from the actor to the sound source under the mouse, every emitting actor and
+    // every actor a pulse could reach, in one batch. Distances are from the end of the last step,
+    // the same ones ScheduleEchoes reads.
+    occlusionSources.clear();
+    occlusionActors.clear();
+    occlusionSources.push_back(mousePos);
+    for (std::size_t i = 0; i < actors.Size(); ++i)
+    {
+        if (i == playerIndex)
+            continue;
+        if (actors.emitterState[i] == ActorEmitting || actors.listenerDistance[i] <= maxRadarRadius)
+        {
+            occlusionSources.push_back(actors.GetPosition(i));
+            occlusionActors.push_back(i);
+        }
+    }
+    occlusionResults.resize(occlusionSources.size());
+    occluderGrid.Query(ballPos, occlusionSources.data(), occlusionSources.size(), occlusionResults.data());
+    actorOcclusion.resize(actors.Size());
+    for (std::size_t j = 0; j < occlusionActors.size(); ++j)
+    {
+        actorOcclusion[occlusionActors[j]] = occlusionResults[j + 1];
+    }
+    const OcclusionResult& occlusion = occlusionResults[0];
+
+    // Mouse position and angle calculation with main actor
+    sf::Vector2f toMouse = mousePos - ballPos;
+    float mouseBallDistance = std::sqrt(toMouse.x * toMouse.x + toMouse.y * toMouse.y);
+    focusRadian = fasttrig::Atan2(toMouse.y, toMouse.x);
+
+    float normalizedDistance = std::min(mouseBallDistance, maxDistance) / maxDistance;
+    float invertedNormalizedDistance = 1.0f - normalizedDistance;
+
+    // Focus shape sector width
+    outerRadius = minRadius + normalizedDistance * (maxRadius - minRadius);
+    sectorWidth = minSectorWidth + invertedNormalizedDistance * (maxSectorWidth - minSectorWidth);
+
+    // Source under the mouse relative to the listener, screen y maps to Steam Audio z
+    SpatialMixer::SourceParams sourceParams;
+    if (mouseBallDistance > 1e-3f)
+        sourceParams.direction = {toMouse.x / mouseBallDistance, 0.f, toMouse.y / mouseBallDistance};
+    sourceParams.occlusion = occlusion.occlusion;
+    sourceParams.transmission = occlusion.transmission;
+    sourceParams.distance = mouseBallDistance * metersPerPixel;
+    sourceParams.focusRadian = focusRadian;
+    sourceParams.focusWidth = sectorWidth;
+    mixer.SetSourceParams(sourceParams);
+
+    // Spatialized pulses start the ring when the mixer says they become audible
+    unsigned pulseCount = mixer.GetPulseCount();
+    if (pulseCount != lastPulseCount)
+    {
+        lastPulseCount = pulseCount;
+        StartRadar(mixer.GetLastPulseTime());
+        ScheduleEchoes(ballPos);
+    }
+    if (input.radarTriggers != lastRadarTriggers)
+    {
+        lastRadarTriggers = input.radarTriggers;
+        StartRadar(std::chrono::steady_clock::now());
+    }
+
+    actors.SetVelocity(playerIndex, input.moveVelocity);
+    actors.Integrate(deltaTime, {0.f, 0.f}, worldSize);
+    ballPos = actors.GetPosition(playerIndex);
+    actors.UpdateListenerDistance(ballPos);
+
+    // The cone is answered from the grid, only cells on its edge test actors one by one
+    float playerSpeed = std::sqrt(input.moveVelocity.x * input.moveVelocity.x + input.moveVelocity.y * input.moveVelocity.y);
+    float maxMove = std::max(wanderSpeed * std::sqrt(2.f), playerSpeed) * deltaTime;
+    focusGrid.Update(actors.posX.data(), actors.posY.data(), actors.Size(), maxMove);
+    focusGrid.QuerySector(actors.posX.data(), actors.posY.data(), actors.listenerDistance.data(), ballPos, focusRadian, sectorWidth,
+                          outerRadius, actors.inFocus.data());
+
+    UpdateRadar(deltaTime);
+
+    ++stepCount;
+    timestep = deltaTime;
+    stepTime = std::chrono::steady_clock::now();
+}
+
+void Simulation::WriteSnapshot(FrameSnapshot& snapshot, float simMs) const
+{
+    snapshot.step = stepCount;
+    snapshot.stepTime = stepTime;
+    snapshot.timestep = timestep;
+    snapshot.simMs = simMs;
+
+    // assign() reuses the snapshot's storage once it has grown to the actor count
+    snapshot.prevX.assign(prevX.begin(), prevX.end());
+    snapshot.prevY.assign(prevY.begin(), prevY.end());
+    snapshot.posX.assign(actors.posX.begin(), actors.posX.end());
+    snapshot.posY.assign(actors.posY.begin(), actors.posY.end());
+    snapshot.radius.assign(actors.radius.begin(), actors.radius.end());
+    snapshot.color.resize(actors.Size());
+    for (std::size_t i = 0; i < actors.Size(); ++i)
+    {
+        snapshot.color[i] = actors.inFocus[i] ? focusHighlightColor : actors.color[i];
+    }
+
+    snapshot.listenerPrev = listenerPrev;
+    snapshot.listener = actors.GetPosition(playerIndex);
+    snapshot.mousePos = mousePos;
+
+    snapshot.focusRadian = focusRadian;
+    snapshot.focusDegree = (focusRadian * 180) / piVal;
+    snapshot.outerRadius = outerRadius;
+    snapshot.startAngle = focusRadian - (sectorWidth * 0.5f);
+    snapshot.endAngle = focusRadian + (sectorWidth * 0.5f);
+
+    snapshot.radarRadiusPrev = radarRadiusPrev;
+    snapshot.radarRadius = radarRadius;
+    snapshot.radarAlpha = radarAlpha;
+    snapshot.radarExpanding = isRadarExpanding;
+}
+
+void Simulation::StartRadar(std::chrono::steady_clock::time_point startTime)
+{
+    isRadarPending = true;
+    isRadarExpanding = false;
+    radarStartTime = startTime;
+    radarRadius = minRadarRadius;
+    radarRadiusPrev = minRadarRadius;
+}
+
+// Every actor the ring reaches echoes back at the moment the ring crosses it, timed in samples
+// from the pulse's first sample. Distances are from the end of the previous step, like the positions.
+void Simulation::ScheduleEchoes(sf::Vector2f listener)
+{
+    const std::uint64_t pulseSample = mixer.GetLastPulseSample();
+    const float samplesPerPixel = mixer.GetSamplingRate() / radarSpeed;
+
+    // Actors in the focus cone always answer and come back louder, the rest share what is left of the budget
+    std::size_t focused = 0;
+    std::size_t unfocused = 0;
+    for (std::size_t i = 0; i < actors.Size(); ++i)
+    {
+        if (i == playerIndex || actors.listenerDistance[i] > maxRadarRadius)
+            continue;
+        if (actors.inFocus[i])
+            ++focused;
+        else
+            ++unfocused;
+    }
+    focused = std::min(focused, maxEchoesPerPulse);
+    std::size_t budget = maxEchoesPerPulse - focused;
+
+    // Every stride-th unfocused actor answers, louder so the overall level holds
+    std::size_t stride = budget > 0 ? unfocused / budget + 1 : 0;
+    float gain = echoGain * std::sqrt(static_cast<float>(stride));
+
+    echoBatch.clear();
+    std::size_t seen = 0;
+    for (std::size_t i = 0; i < actors.Size() && echoBatch.size() < maxEchoesPerPulse; ++i)
+    {
+        float distance = actors.listenerDistance[i];
+        if (i == playerIndex || distance > maxRadarRadius)
+            continue;
+        bool inFocus = actors.inFocus[i] != 0;
+        if (!inFocus && (stride == 0 || seen++ % stride != 0))
+            continue;
+
+        SpatialMixer::Echo echo;
+        echo.sample = pulseSample + static_cast<std::uint64_t>(std::max(0.f, distance - minRadarRadius) * samplesPerPixel);
+        if (distance > 1e-3f)
+            echo.direction = {(actors.posX[i] - listener.x) / distance, 0.f, (actors.posY[i] - listener.y) / distance};
+        echo.gain = (inFocus ? echoGain * focusEchoBoost : gain) * (1.f - distance / maxRadarRadius);
+        echo.focused = inFocus;
+        echo.occlusion = actorOcclusion[i].occlusion;
+        echo.transmission = actorOcclusion[i].transmission;
+        echoBatch.push_back(echo);
+    }
+    mixer.ScheduleEchoes(echoBatch.data(), echoBatch.size());
+}
+
+// Radar circle action
+void Simulation::UpdateRadar(float deltaTime)
+{
+    std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+    if (isRadarPending && now >= radarStartTime)
+    {
+        // Start from where the ring would be had it begun exactly at the audible time
+        isRadarPending = false;
+        isRadarExpanding = true;
+        float late = std::chrono::duration<float>(now - radarStartTime).count();
+        radarRadius = minRadarRadius + radarSpeed * late;
+        radarRadiusPrev = radarRadius;
+        deltaTime = 0.f;
+    }
+
+    if (isRadarExpanding)
+    {
+        radarRadius += radarSpeed * deltaTime;
+        float alphaPercentage = 1.0f - (radarRadius / maxRadarRadius);
+        int alpha = static_cast<int>(255 * alphaPercentage);
+        radarAlpha = std::max(0, std::min(50, alpha));
+
+        if (radarRadius >= maxRadarRadius)
+        {
+            isRadarExpanding = false;
+            radarRadius = minRadarRadius;
+            radarRadiusPrev = minRadarRadius;
+        }
+    }
+}
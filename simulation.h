@@ -0,0 +1,112 @@
+//---------------------Fixed timestep simulation producing immutable frame snapshots---------------------------
+#pragma once
+
+#include "actorstore.h"
+#include "focusgrid.h"
+#include "occlusion.h"
+#include "spatialmixer.h"
+#include <SFML/Graphics/Color.hpp>
+#include <SFML/System/Vector2.hpp>
+#include <chrono>
+#include <cstdint>
+#include <vector>
+
+// Sampled by the render thread every frame, triggers are running counters.
+// Spatialized pulses skip this and go straight to the mixer with their keypress time.
+struct InputState
+{
+    sf::Vector2f mousePos;
+    sf::Vector2f moveVelocity;
+    unsigned radarTriggers = 0;
+};
+
+// Everything the render thread needs to draw one frame. Positions are kept for the
+// previous and the current step so rendering can interpolate between them.
+struct FrameSnapshot
+{
+    std::uint64_t step = 0;
+    std::chrono::steady_clock::time_point stepTime;
+    float timestep = 0.f;
+    float simMs = 0.f;
+
+    std::vector<float> prevX;
+    std::vector<float> prevY;
+    std::vector<float> posX;
+    std::vector<float> posY;
+    std::vector<float> radius;
+    std::vector<sf::Color> color;
+
+    sf::Vector2f listenerPrev;
+    sf::Vector2f listener;
+    sf::Vector2f mousePos;
+
+    // Focus shape and grid angle offset
+    float focusRadian = 0.f;
+    float focusDegree = 0.f;
+    float outerRadius = 0.f;
+    float startAngle = 0.f;
+    float endAngle = 0.f;
+
+    // Radar state
+    float radarRadiusPrev = 0.f;
+    float radarRadius = 0.f;
+    int radarAlpha = 0;
+    bool radarExpanding = false;
+};
+
+class Simulation
+{
+public:
+    Simulation(SpatialMixer& mixer, int actorCount, sf::Vector2f worldSize);
+
+    void Step(float deltaTime, const InputState& input);
+    void WriteSnapshot(FrameSnapshot& snapshot, float simMs) const;
+
+    const std::vector<OccluderSegment>& GetOccluders() const { return occluderGrid.GetSegments(); }
+
+private:
+    void StartRadar(std::chrono::steady_clock::time_point startTime);
+    void UpdateRadar(float deltaTime);
+    void ScheduleEchoes(sf::Vector2f listener);
+
+    SpatialMixer& mixer;
+    sf::Vector2f worldSize;
+
+    ActorStore actors;
+    std::vector<float> prevX;
+    std::vector<float> prevY;
+    std::size_t playerIndex;
+    sf::Color focusHighlightColor;
+    OccluderGrid occluderGrid;
+    FocusGrid focusGrid;
+
+    std::uint64_t stepCount;
+    std::chrono::steady_clock::time_point stepTime;
+    float timestep;
+    sf::Vector2f mousePos;
+    sf::Vector2f listenerPrev;
+
+    float focusRadian;
+    float outerRadius;
+    float sectorWidth;
+
+    float radarRadiusPrev;
+    float radarRadius;
+    int radarAlpha;
+    bool isRadarExpanding;
+
+    // The ring waits for the pulse to become audible, then catches up to the elapsed time
+    bool isRadarPending;
+    std::chrono::steady_clock::time_point radarStartTime;
+
+    unsigned lastPulseCount;
+    unsigned lastRadarTriggers;
+    std::vector<SpatialMixer::Echo> echoBatch;
+
+    // One batched line of sight query per step, the mouse source first, then the actors in
+    // occlusionActors. actorOcclusion is indexed by actor and only valid for those queried.
+    std::vector<sf::Vector2f> occlusionSources;
+    std::vector<std::size_t> occlusionActors;
+    std::vector<OcclusionResult> occlusionResults;
+    std::vector<OcclusionResult> actorOcclusion;
+};
@@ -0,0 +1,489 @@
+//---------------------Streaming spatial mixer with sample-accurate triggers---------------------------
+#include "spatialmixer.h"
+#include "sampleconvert.h"
+#include <SFML/Config.hpp>
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+
+namespace
+{
+    // SFML keeps this many buffers queued, a block filled now plays after the others drain
+    const int streamBufferCount = 3;
+    const std::size_t maxLatencySamples = 4096;
+
+    // Echoes in flight across all pulses, and the number of direction buses they are binned into
+    const std::size_t maxPendingEchoes = 16384;
+    const int echoBusCount = 8;
+    const int focusBusCount = 8;
+    const float echoGrainSeconds = 0.03f;
+    const float twoPi = 6.28318530717958647692f;
+
+    float Percentile(std::vector<float> values, float fraction)
+    {
+        if (values.empty())
+            return 0.f;
+        std::size_t index = std::min(values.size() - 1, static_cast<std::size_t>(fraction * (values.size() - 1) + 0.5f));
+        std::nth_element(values.begin(), values.begin() + index, values.end());
+        return values[index];
+    }
+}
+
+SpatialMixer::SpatialMixer(SteamAudioManager& steamAudio, const float* clip, std::size_t clipSize, int voiceCount) :
+    steamAudio(steamAudio),
+    clip(clip),
+    clipSize(clipSize),
+    frameSize(steamAudio.GetFrameSize()),
+    samplingRate(steamAudio.GetSamplingRate()),
+    voices(voiceCount),
+    delayLines(voiceCount, samplingRate, frameSize),
+    doppler(true),
+    voiceLimit(voiceCount),
+    bilinearHrtf(true),
+    peakLoad(0.f),
+    focusStart(0.f),
+    focusWidth(0.f),
+    triggers(64),
+    echoRequests(maxPendingEchoes),
+    echoWheel(maxPendingEchoes),
+    droppedEchoes(0),
+    output(nullptr),
+    queuedSeconds((streamBufferCount - 1) * double(frameSize) / samplingRate),
+    samplesRendered(0),
+    voiceInput(std::size_t(voiceCount) * frameSize),
+    delayedInput(std::size_t(voiceCount) * frameSize),
+    delayInputs(voiceCount, nullptr),
+    delayOutputs(voiceCount, nullptr),
+    voiceOutput(frameSize * 2),
+    mixBuffer(frameSize * 2),
+    carryFrames(0),
+    outputBuffer(frameSize * 2),
+    pulseCount(0),
+    lastPulseTime(0),
+    lastPulseSample(0),
+    pendingPulses(64),
+    holdingPulse(false)
+{
+    for (int v = 0; v < voiceCount; ++v)
+    {
+        steamAudio.CreateVoice(voices[v].effects);
+        delayOutputs[v] = &delayedInput[std::size_t(v) * frameSize];
+    }
+
+    // An echo is the head of the pulse clip with a raised cosine fade, short enough that thousands overlap cleanly
+    echoGrain.resize(std::max(1, static_cast<int>(echoGrainSeconds * samplingRate)));
+    for (std::size_t i = 0; i < echoGrain.size(); ++i)
+    {
+        float fade = 0.5f + 0.5f * std::cos(0.5f * twoPi * i / echoGrain.size());
+        echoGrain[i] = i < clipSize ? clip[i] * fade : 0.f;
+    }
+    echoBuses.resize(echoBusCount);
+    for (int b = 0; b < echoBusCount; ++b)
+    {
+        float angle = twoPi * b / echoBusCount;
+        echoBuses[b].direction = {std::cos(angle), 0.f, std::sin(angle)};
+        echoBuses[b].pending.assign(frameSize + echoGrain.size(), 0.f);
+        steamAudio.CreateVoice(echoBuses[b].effects);
+    }
+    focusBuses.resize(focusBusCount);
+    for (EchoBus& bus : focusBuses)
+    {
+        bus.interpolation = IPL_HRTFINTERPOLATION_BILINEAR;
+        bus.pending.assign(frameSize + echoGrain.size(), 0.f);
+        steamAudio.CreateVoice(bus.effects);
+    }
+
+    audibleLatencyMs.reserve(maxLatencySamples);
+
+    initialize(2, samplingRate);
+#if SFML_VERSION_MAJOR > 2 || (SFML_VERSION_MAJOR == 2 && SFML_VERSION_MINOR >= 6)
+    // Refill as soon as a buffer drains rather than on SFML's default 10 ms poll
+    setProcessingInterval(sf::milliseconds(1));
+#endif
+}
+
+SpatialMixer::~SpatialMixer()
+{
+    Shutdown();
+}
+
+bool SpatialMixer::Start(AudioOutput* audioOutput)
+{
+    if (!audioOutput)
+    {
+        play();
+        return true;
+    }
+
+    if (audioOutput->GetSettings().samplingRate != samplingRate || audioOutput->GetSettings().channels != 2)
+    {
+        std::cerr << "Audio output " << audioOutput->GetName() << " is not stereo at " << samplingRate << " Hz" << std::endl;
+        return false;
+    }
+
+    // A period is rendered once one is free, the rest of the device buffer is still queued ahead of it
+    const AudioOutputSettings& settings = audioOutput->GetSettings();
+    queuedSeconds = audioOutput->GetLatencySeconds() - double(settings.periodFrames) / settings.samplingRate;
+    output = audioOutput;
+    if (!output->Start(*this))
+    {
+        output = nullptr;
+        return false;
+    }
+    return true;
+}
+
+void SpatialMixer::Shutdown()
+{
+    // The stream thread must be gone before the effects it uses are released
+    if (output)
+        output->Stop();
+    output = nullptr;
+    stop();
+    for (Voice& voice : voices)
+    {
+        if (voice.effects.binauralEffect)
+            steamAudio.ReleaseVoice(voice.effects);
+        voice.active = false;
+    }
+    for (StreamVoice& voice : streamVoices)
+    {
+        steamAudio.ReleaseVoice(voice.effects);
+    }
+    streamVoices.clear();
+    for (std::vector<EchoBus>* buses : { &echoBuses, &focusBuses })
+    {
+        for (EchoBus& bus : *buses)
+        {
+            if (bus.effects.binauralEffect)
+                steamAudio.ReleaseVoice(bus.effects);
+        }
+    }
+}
+
+bool SpatialMixer::AttachStream(DecodeService& decoder, int streamId, const IPLVector3& direction)
+{
+    StreamVoice voice;
+    if (streamId < 0 || !steamAudio.CreateVoice(voice.effects))
+        return false;
+
+    voice.decoder = &decoder;
+    voice.streamId = streamId;
+    voice.direction = direction;
+    streamVoices.push_back(voice);
+    return true;
+}
+
+void SpatialMixer::SetVoiceLimit(int limit)
+{
+    voiceLimit.store(std::max(1, std::min(static_cast<int>(voices.size()), limit)), std::memory_order_relaxed);
+}
+
+bool SpatialMixer::Trigger(TimePoint pressTime)
+{
+    if (!triggers.Push(pressTime))
+    {
+        std::cerr << "Spatial mixer trigger queue full, pulse dropped." << std::endl;
+        return false;
+    }
+    return true;
+}
+
+void SpatialMixer::SetSourceParams(const SourceParams& params)
+{
+    sourceParams.WriteBuffer() = params;
+    sourceParams.Publish();
+}
+
+std::size_t SpatialMixer::ScheduleEchoes(const Echo* echoes, std::size_t count)
+{
+    std::size_t queued = echoRequests.Write(echoes, count);
+    if (queued < count)
+        droppedEchoes.fetch_add(static_cast<unsigned>(count - queued), std::memory_order_relaxed);
+    return queued;
+}
+
+SpatialMixer::TimePoint SpatialMixer::GetLastPulseTime() const
+{
+    return TimePoint(TimePoint::duration(lastPulseTime.load(std::memory_order_acquire)));
+}
+
+bool SpatialMixer::onGetData(Chunk& data)
+{
+    RenderBlock(mixBuffer.data());
+    FloatToInt16(mixBuffer.data(), outputBuffer.data(), mixBuffer.size());
+
+    data.samples = outputBuffer.data();
+    data.sampleCount = outputBuffer.size();
+    return true;
+}
+
+void SpatialMixer::onSeek(sf::Time)
+{
+}
+
+void SpatialMixer::Render(float* interleaved, int frameCount)
+{
+    // Left over from a block split across the previous call
+    int carried = std::min(carryFrames, frameCount);
+    const float* carry = mixBuffer.data() + std::size_t(frameSize - carryFrames) * 2;
+    std::copy(carry, carry + carried * 2, interleaved);
+    carryFrames -= carried;
+    interleaved += carried * 2;
+    frameCount -= carried;
+
+    // Whole blocks go straight into the device buffer
+    while (frameCount >= frameSize)
+    {
+        RenderBlock(interleaved);
+        interleaved += frameSize * 2;
+        frameCount -= frameSize;
+    }
+
+    if (frameCount > 0)
+    {
+        RenderBlock(mixBuffer.data());
+        std::copy(mixBuffer.begin(), mixBuffer.begin() + frameCount * 2, interleaved);
+        carryFrames = frameSize - frameCount;
+    }
+}
+
+void SpatialMixer::RenderBlock(float* out)
+{
+    const std::size_t outSize = std::size_t(frameSize) * 2;
+    TimePoint callbackTime = std::chrono::steady_clock::now();
+    IPLHRTFInterpolation interpolation = bilinearHrtf.load(std::memory_order_relaxed) ? IPL_HRTFINTERPOLATION_BILINEAR : IPL_HRTFINTERPOLATION_NEAREST;
+
+    sourceParams.Acquire();
+    const SourceParams& params = sourceParams.ReadBuffer();
+    float delay = doppler ? delayLines.DistanceToDelay(params.distance) : 1.f;
+
+    TimePoint pressTime;
+    while (triggers.Pop(pressTime))
+    {
+        StartVoice(pressTime, callbackTime, delay);
+    }
+
+    // Clip blocks for every active voice first, one SIMD pass then runs them all through their delay lines
+    bool anyActive = false;
+    for (std::size_t v = 0; v < voices.size(); ++v)
+    {
+        Voice& voice = voices[v];
+        delayInputs[v] = nullptr;
+        if (!voice.active || !voice.effects.binauralEffect)
+            continue;
+
+        // Silence up to the trigger offset, then as much of the clip as is left, then silence while the delay line drains
+        float* input = &voiceInput[v * frameSize];
+        std::size_t remaining = voice.position < clipSize ? clipSize - voice.position : 0;
+        std::size_t count = std::min<std::size_t>(frameSize - voice.startOffset, remaining);
+        std::fill(input, input + voice.startOffset, 0.f);
+        if (count > 0)
+            std::copy(clip + voice.position, clip + voice.position + count, input + voice.startOffset);
+        std::fill(input + voice.startOffset + count, input + frameSize, 0.f);
+        voice.position += frameSize - voice.startOffset;
+        voice.startOffset = 0;
+
+        delayInputs[v] = input;
+        delayLines.SetTargetDelay(static_cast<int>(v), delay);
+        anyActive = true;
+    }
+    if (anyActive)
+        delayLines.Process(delayInputs.data(), delayOutputs.data(), frameSize);
+
+    std::fill(out, out + outSize, 0.f);
+    for (std::size_t v = 0; v < voices.size(); ++v)
+    {
+        Voice& voice = voices[v];
+        if (!delayInputs[v])
+            continue;
+
+        steamAudio.ProcessBlock(voice.effects, delayOutputs[v], voiceOutput.data(), params.direction, params.occlusion, params.transmission, interpolation);
+        for (std::size_t i = 0; i < outSize; ++i)
+        {
+            out[i] += voiceOutput[i];
+        }
+
+        // Finished once the clip and whatever was still inside the delay line have played
+        if (voice.position >= clipSize + static_cast<std::size_t>(delayLines.GetDelay(static_cast<int>(v))) + 4)
+        {
+            voice.active = false;
+            steamAudio.ResetVoice(voice.effects);
+        }
+    }
+
+    // Focus buses follow the cone, each covers an equal share of its width
+    focusStart = params.focusRadian - params.focusWidth * 0.5f;
+    focusWidth = params.focusWidth;
+    for (int b = 0; b < focusBusCount; ++b)
+    {
+        float angle = focusStart + focusWidth * (b + 0.5f) / focusBusCount;
+        focusBuses[b].direction = {std::cos(angle), 0.f, std::sin(angle)};
+    }
+
+    // Requests go on the wheel, the ones due in this block land in their bus at the exact sample
+    Echo echo;
+    while (echoRequests.Pop(echo))
+    {
+        if (!echoWheel.Schedule(echo.sample, echo))
+            droppedEchoes.fetch_add(1, std::memory_order_relaxed);
+    }
+    echoWheel.Advance(samplesRendered + frameSize, [this](std::uint64_t sample, const Echo& due)
+    {
+        MixEcho(static_cast<int>(sample - samplesRendered), due);
+    });
+
+    for (std::vector<EchoBus>* buses : { &echoBuses, &focusBuses })
+    {
+        for (EchoBus& bus : *buses)
+        {
+            if (bus.busySamples <= 0 || !bus.effects.binauralEffect)
+                continue;
+
+            // Coarse buses stay on nearest even at full quality
+            IPLHRTFInterpolation busInterpolation = interpolation == IPL_HRTFINTERPOLATION_BILINEAR ? bus.interpolation : interpolation;
+            steamAudio.ProcessBlock(bus.effects, bus.pending.data(), voiceOutput.data(), bus.direction, 1.f, 1.f, busInterpolation);
+            for (std::size_t i = 0; i < outSize; ++i)
+            {
+                out[i] += voiceOutput[i];
+            }
+
+            // Grains that ran past the block move to the front for the next one
+            std::copy(bus.pending.begin() + frameSize, bus.pending.end(), bus.pending.begin());
+            std::fill(bus.pending.end() - frameSize, bus.pending.end(), 0.f);
+            bus.busySamples -= frameSize;
+        }
+    }
+
+    // Streams never block here, a starved ring reads as silence and is counted by the decoder
+    for (StreamVoice& voice : streamVoices)
+    {
+        voice.decoder->Read(voice.streamId, voiceInput.data(), frameSize);
+        steamAudio.ProcessBlock(voice.effects, voiceInput.data(), voiceOutput.data(), voice.direction, 1.f, 1.f, interpolation);
+        for (std::size_t i = 0; i < outSize; ++i)
+        {
+            out[i] += voiceOutput[i];
+        }
+    }
+
+    samplesRendered += frameSize;
+
+    // Only this thread raises the peak, the reader resets it
+    float load = static_cast<float>(std::chrono::duration<double>(std::chrono::steady_clock::now() - callbackTime).count() * samplingRate / frameSize);
+    if (load > peakLoad.load(std::memory_order_relaxed))
+        peakLoad.store(load, std::memory_order_relaxed);
+}
+
+void SpatialMixer::StartVoice(TimePoint pressTime, TimePoint callbackTime, float delaySamples)
+{
+    using Seconds = std::chrono::duration<double>;
+
+    // Every press is delayed by exactly one block, which keeps its sample position inside
+    // the block rendered right after it no matter where between callbacks it landed
+    double blockSeconds = double(frameSize) / samplingRate;
+    double lateBy = Seconds(callbackTime - pressTime).count();
+    int offset = static_cast<int>(std::lround((blockSeconds - lateBy) * samplingRate));
+    offset = std::max(0, std::min(frameSize - 1, offset));
+
+    // Steal the voice furthest into its clip when all the allowed ones are busy
+    Voice* target = &voices[0];
+    int limit = voiceLimit.load(std::memory_order_relaxed);
+    for (int v = 0; v < limit; ++v)
+    {
+        Voice& voice = voices[v];
+        if (!voice.active)
+        {
+            target = &voice;
+            break;
+        }
+        if (voice.position > target->position)
+            target = &voice;
+    }
+    if (target->active)
+        steamAudio.ResetVoice(target->effects);
+
+    target->active = true;
+    target->position = 0;
+    target->startOffset = offset;
+
+    // A new pulse starts at the current distance instead of ramping from where the last one ended
+    delayLines.ResetVoice(static_cast<int>(target - voices.data()), delaySamples);
+
+    // Emission time, the propagation delay on top of it is part of the scene rather than the latency
+    double offsetSeconds = double(offset) / samplingRate;
+    TimePoint audibleTime = callbackTime + std::chrono::duration_cast<TimePoint::duration>(Seconds(offsetSeconds + queuedSeconds));
+
+    lastPulseSample.store(samplesRendered + offset, std::memory_order_release);
+    lastPulseTime.store(audibleTime.time_since_epoch().count(), std::memory_order_release);
+    pulseCount.fetch_add(1, std::memory_order_acq_rel);
+
+    // Nobody times them when the ring is full, the pulse still plays
+    PendingPulse pending;
+    pending.pressTime = pressTime;
+    pending.sample = samplesRendered + offset;
+    pendingPulses.Push(pending);
+}
+
+void SpatialMixer::MixEcho(int offset, const Echo& echo)
+{
+    // Nearest bus by azimuth, direction is x/z with z along screen y
+    float angle = std::atan2(echo.direction.z, echo.direction.x);
+    EchoBus* bus;
+    if (echo.focused && focusWidth > 0.f)
+    {
+        // Echoes that left the cone since they were scheduled stay on its nearest edge
+        float intoCone = std::fmod(angle - focusStart + 2.f * twoPi, twoPi);
+        if (intoCone > focusWidth)
+            intoCone = intoCone - focusWidth < twoPi - intoCone ? focusWidth : 0.f;
+        int bin = std::min(focusBusCount - 1, static_cast<int>(intoCone / focusWidth * focusBusCount));
+        bus = &focusBuses[bin];
+    }
+    else
+    {
+        int bin = static_cast<int>(std::lround(angle / twoPi * echoBusCount));
+        bus = &echoBuses[(bin % echoBusCount + echoBusCount) % echoBusCount];
+    }
+
+    // Buses are shared, so the frequency independent direct effect is applied here as the gain it
+    // amounts to: the visible part plus what the walls let through
+    float gain = echo.gain * (echo.occlusion + (1.f - echo.occlusion) * echo.transmission);
+    float* target = bus->pending.data() + offset;
+    for (std::size_t i = 0; i < echoGrain.size(); ++i)
+    {
+        target[i] += gain * echoGrain[i];
+    }
+    bus->busySamples = std::max(bus->busySamples, offset + static_cast<int>(echoGrain.size()) + frameSize);
+}
+
+void SpatialMixer::UpdateLatency()
+{
+    // Both count frames from the start of the stream, as samplesRendered does
+    std::uint64_t played;
+    if (output)
+        played = output->GetPlayedFrames();
+    else
+        played = static_cast<std::uint64_t>(std::max<sf::Int64>(0, getPlayingOffset().asMicroseconds()) * samplingRate / 1000000);
+    TimePoint now = std::chrono::steady_clock::now();
+
+    while (holdingPulse || pendingPulses.Pop(heldPulse))
+    {
+        holdingPulse = true;
+        if (heldPulse.sample > played)
+            return;
+        holdingPulse = false;
+
+        // Backdated by how far the play position has moved past the pulse's first sample
+        std::chrono::duration<double> sincePlayed(double(played - heldPulse.sample) / samplingRate);
+        TimePoint audibleTime = now - std::chrono::duration_cast<TimePoint::duration>(sincePlayed);
+        if (audibleLatencyMs.size() < maxLatencySamples)
+            audibleLatencyMs.push_back(static_cast<float>(std::chrono::duration<double, std::milli>(audibleTime - heldPulse.pressTime).count()));
+    }
+}
+
+void SpatialMixer::ReportLatency(std::ostream& out) const
+{
+    out << "Keypress to first sample played, " << audibleLatencyMs.size() << " pulses, position from "
+        << (output ? output->GetName() : "SFML playing offset") << std::endl;
+    out << "  p50 " << Percentile(audibleLatencyMs, 0.5f) << " ms, p90 " << Percentile(audibleLatencyMs, 0.9f)
+        << " ms, p99 " << Percentile(audibleLatencyMs, 0.99f) << " ms" << std::endl;
+}
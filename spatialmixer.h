@@ -0,0 +1,198 @@
+//---------------------Streaming spatial mixer with sample-accurate triggers---------------------------
+#pragma once
+
+#include "decodeservice.h"
+#include "audiooutput.h"
+#include "delayline.h"
+#include "framepipeline.h"
+#include "ringbuffer.h"
+#include "steamaudiomanager.h"
+#include "timingwheel.h"
+#include <SFML/Audio.hpp>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <ostream>
+#include <vector>
+
+// Renders one Steam Audio frame per SFML stream callback, or straight into the period buffer
+// of an AudioOutput as float. Triggers carry the time of the keypress and start at the matching
+// sample inside the block rendered right after it, so latency is constant instead of jittering
+// with the video frame and SFML buffer timing.
+class SpatialMixer : public sf::SoundStream, public AudioRenderer
+{
+public:
+    using TimePoint = std::chrono::steady_clock::time_point;
+
+    // Written by the simulation thread, picked up at the start of every audio block
+    struct SourceParams
+    {
+        IPLVector3 direction = {0.f, 0.f, -1.f};
+        float occlusion = 1.f;
+        float transmission = 1.f;
+        // Listener to source in metres, sets the propagation delay and with it the Doppler shift
+        float distance = 0.f;
+        // Listener's focus cone, in-cone echoes are spread over it with finer, interpolated HRTFs
+        float focusRadian = 0.f;
+        float focusWidth = 0.f;
+    };
+
+    // One echo of a radar pulse, sample counts on the render timeline GetLastPulseSample uses
+    struct Echo
+    {
+        std::uint64_t sample = 0;
+        IPLVector3 direction = {0.f, 0.f, -1.f};
+        float gain = 0.f;
+        bool focused = false;
+        // Line of sight to the echoing actor, as SourceParams carries it for the pulse voices
+        float occlusion = 1.f;
+        float transmission = 1.f;
+    };
+
+    // clip is mono at the engine rate and must outlive the mixer, it may point straight into a mapped bundle
+    SpatialMixer(SteamAudioManager& steamAudio, const float* clip, std::size_t clipSize, int voiceCount = 8);
+    ~SpatialMixer();
+
+    // Plays through SFML's int16 stream without an output, otherwise the opened output pulls float
+    // periods on its own thread and SFML is bypassed
+    bool Start(AudioOutput* output = nullptr);
+
+    // Stops the stream and releases the voices, call before SteamAudioManager::CleanUp
+    void Shutdown();
+
+    // Continuous source fed by the decode service at a fixed direction, call before Start()
+    bool AttachStream(DecodeService& decoder, int streamId, const IPLVector3& direction);
+
+    // Without Doppler pulses play with a fixed one sample delay, call before Start()
+    void SetDopplerEnabled(bool enabled) { doppler = enabled; }
+
+    // Output thread, any frame count. Whole blocks are mixed in place, a partial one is carried over.
+    void Render(float* interleaved, int frameCount) override;
+
+    // Any thread, quality knobs picked up by the next block. Voices above the limit finish their
+    // pulse but take no new ones. Without bilinear every voice and bus uses nearest HRTF.
+    void SetVoiceLimit(int limit);
+    void SetBilinearHrtf(bool enabled) { bilinearHrtf.store(enabled, std::memory_order_relaxed); }
+
+    // Worst block render time since the last call, as a fraction of the block duration
+    float TakePeakLoad() { return peakLoad.exchange(0.f, std::memory_order_relaxed); }
+
+    // Input thread
+    bool Trigger(TimePoint pressTime);
+
+    // Simulation thread
+    void SetSourceParams(const SourceParams& params);
+
+    // Simulation thread, returns how many were queued. Echoes are mixed at their exact sample
+    // into one of a fixed set of direction buses, so thousands per pulse cost no extra voices.
+    // Focused echoes go to buses packed across the focus cone with bilinear HRTF interpolation,
+    // the rest to coarse buses around the listener with nearest HRTF.
+    std::size_t ScheduleEchoes(const Echo* echoes, std::size_t count);
+    int GetSamplingRate() const { return samplingRate; }
+    unsigned GetDroppedEchoes() const { return droppedEchoes.load(std::memory_order_relaxed); }
+
+    // Any thread, estimated time the newest pulse becomes audible
+    unsigned GetPulseCount() const { return pulseCount.load(std::memory_order_acquire); }
+    TimePoint GetLastPulseTime() const;
+    std::uint64_t GetLastPulseSample() const { return lastPulseSample.load(std::memory_order_acquire); }
+
+    // Main thread, once per frame. Times the first sample of every started pulse against the
+    // output's play position, the device's queued frames or SFML's playing offset.
+    void UpdateLatency();
+    // Main thread, keypress to the first sample leaving the device
+    void ReportLatency(std::ostream& out) const;
+
+protected:
+    bool onGetData(Chunk& data) override;
+    void onSeek(sf::Time timeOffset) override;
+
+private:
+    struct Voice
+    {
+        SteamAudioVoice effects;
+        bool active = false;
+        std::size_t position = 0;
+        int startOffset = 0;
+    };
+
+    // Started by the audio thread, timed by UpdateLatency once the play position passes it
+    struct PendingPulse
+    {
+        TimePoint pressTime;
+        std::uint64_t sample = 0;
+    };
+
+    struct StreamVoice
+    {
+        SteamAudioVoice effects;
+        DecodeService* decoder = nullptr;
+        int streamId = -1;
+        IPLVector3 direction = {0.f, 0.f, -1.f};
+    };
+
+    // Fixed direction voice that echoes are summed into, pending spans one block plus a grain
+    struct EchoBus
+    {
+        SteamAudioVoice effects;
+        IPLVector3 direction = {0.f, 0.f, -1.f};
+        IPLHRTFInterpolation interpolation = IPL_HRTFINTERPOLATION_NEAREST;
+        std::vector<float> pending;
+        int busySamples = 0;
+    };
+
+    // Mixes one frame of stereo into out, which is overwritten
+    void RenderBlock(float* out);
+    void StartVoice(TimePoint pressTime, TimePoint callbackTime, float delaySamples);
+    void MixEcho(int offset, const Echo& echo);
+
+    SteamAudioManager& steamAudio;
+    const float* clip;
+    std::size_t clipSize;
+    int frameSize;
+    int samplingRate;
+
+    std::vector<Voice> voices;
+    DelayLineBank delayLines;
+    bool doppler;
+    std::vector<StreamVoice> streamVoices;
+    std::atomic<int> voiceLimit;
+    std::atomic<bool> bilinearHrtf;
+    std::atomic<float> peakLoad;
+    std::vector<EchoBus> echoBuses;
+    std::vector<EchoBus> focusBuses;
+    std::vector<float> echoGrain;
+    float focusStart;
+    float focusWidth;
+    SpscRing<TimePoint> triggers;
+    SpscRing<Echo> echoRequests;
+    TimingWheel<Echo> echoWheel;
+    std::atomic<unsigned> droppedEchoes;
+    TripleBuffer<SourceParams> sourceParams;
+
+    AudioOutput* output;
+    // Audio queued ahead of the block being rendered, for the audible time estimate
+    double queuedSeconds;
+
+    std::uint64_t samplesRendered;
+    // One block per pulse voice on either side of the delay lines
+    std::vector<float> voiceInput;
+    std::vector<float> delayedInput;
+    std::vector<const float*> delayInputs;
+    std::vector<float*> delayOutputs;
+    std::vector<float> voiceOutput;
+    std::vector<float> mixBuffer;
+    // Frames of the last block in mixBuffer that Render has not handed out yet
+    int carryFrames;
+    std::vector<sf::Int16> outputBuffer;
+
+    std::atomic<unsigned> pulseCount;
+    std::atomic<std::int64_t> lastPulseTime;
+    std::atomic<std::uint64_t> lastPulseSample;
+
+    SpscRing<PendingPulse> pendingPulses;
+    // Popped but not yet played, the ring has no peek
+    PendingPulse heldPulse;
+    bool holdingPulse;
+    // Preallocated, recording stops once it is full
+    std::vector<float> audibleLatencyMs;
+};
@@ -0,0 +1,177 @@
+//---------------------Parallel startup stages with dependencies---------------------------
+#include "startupgraph.h"
+#include <algorithm>
+#include <exception>
+#include <iostream>
+
+namespace
+{
+    double Milliseconds(std::chrono::steady_clock::duration duration)
+    {
+        return std::chrono::duration<double, std::milli>(duration).count();
+    }
+}
+
+StartupGraph::~StartupGraph()
+{
+    Wait();
+}
+
+int StartupGraph::Add(const std::string& name, std::function<bool()> task, std::initializer_list<int> dependencies)
+{
+    Stage stage;
+    stage.name = name;
+    stage.task = std::move(task);
+    stage.dependencies.assign(dependencies.begin(), dependencies.end());
+    stages.push_back(std::move(stage));
+    return static_cast<int>(stages.size()) - 1;
+}
+
+void StartupGraph::Start()
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    started = true;
+    graphStart = Clock::now();
+    graphEnd = graphStart;
+    LaunchReady();
+}
+
+void StartupGraph::LaunchReady()
+{
+    // Skipping a stage can make its own dependents skippable, so repeat until nothing changes
+    bool changed = true;
+    while (changed)
+    {
+        changed = false;
+        for (std::size_t s = 0; s < stages.size(); ++s)
+        {
+            Stage& stage = stages[s];
+            if (stage.state != StagePending)
+                continue;
+
+            bool ready = true;
+            bool blocked = false;
+            for (int dependency : stage.dependencies)
+            {
+                StageState state = stages[dependency].state;
+                ready = ready && state == StageDone;
+                blocked = blocked || state == StageFailed || state == StageSkipped;
+            }
+
+            if (blocked)
+            {
+                stage.state = StageSkipped;
+                ++finishedCount;
+                changed = true;
+            }
+            else if (ready)
+            {
+                stage.state = StageRunning;
+                stage.start = Clock::now();
+                threads.emplace_back(&StartupGraph::Run, this, static_cast<int>(s));
+            }
+        }
+    }
+
+    if (finishedCount == static_cast<int>(stages.size()))
+    {
+        graphEnd = Clock::now();
+        finished.notify_all();
+    }
+}
+
+void StartupGraph::Run(int stage)
+{
+    bool succeeded = false;
+    try
+    {
+        succeeded = stages[stage].task();
+    }
+    catch (const std::exception& e)
+    {
+        std::cerr << "Startup stage " << stages[stage].name << " failed: " << e.what() << std::endl;
+    }
+
+    std::lock_guard<std::mutex> lock(mutex);
+    stages[stage].end = Clock::now();
+    stages[stage].state = succeeded ? StageDone : StageFailed;
+    ++finishedCount;
+    LaunchReady();
+}
+
+bool StartupGraph::IsFinished() const
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    return finishedCount == static_cast<int>(stages.size());
+}
+
+StartupGraph::StageState StartupGraph::GetState(int stage) const
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    return stages[stage].state;
+}
+
+bool StartupGraph::Wait()
+{
+    std::vector<std::thread> running;
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        if (!started)
+            return false;
+        finished.wait(lock, [this]() { return finishedCount == static_cast<int>(stages.size()); });
+        running.swap(threads);
+    }
+    for (std::thread& thread : running)
+    {
+        thread.join();
+    }
+
+    return std::all_of(stages.begin(), stages.end(), [](const Stage& stage) { return stage.state == StageDone; });
+}
+
+void StartupGraph::Report(std::ostream& out) const
+{
+    std::lock_guard<std::mutex> lock(mutex);
+
+    double stageSum = 0.0;
+    int last = -1;
+    for (std::size_t s = 0; s < stages.size(); ++s)
+    {
+        const Stage& stage = stages[s];
+        if (stage.state == StageSkipped || stage.state == StagePending)
+        {
+            out << "[startup] " << stage.name << ": skipped" << std::endl;
+            continue;
+        }
+
+        double duration = Milliseconds(stage.end - stage.start);
+        stageSum += duration;
+        out << "[startup] " << stage.name << ": " << duration << " ms, started at " << Milliseconds(stage.start - graphStart) << " ms"
+            << (stage.state == StageFailed ? " (failed)" : "") << std::endl;
+        if (last < 0 || stage.end > stages[last].end)
+            last = static_cast<int>(s);
+    }
+    if (last < 0)
+        return;
+
+    // Walk back from the stage that finished last through whichever dependency held it up longest
+    std::vector<int> path;
+    for (int s = last; s >= 0;)
+    {
+        path.push_back(s);
+        int blocker = -1;
+        for (int dependency : stages[s].dependencies)
+        {
+            if (blocker < 0 || stages[dependency].end > stages[blocker].end)
+                blocker = dependency;
+        }
+        s = blocker;
+    }
+
+    out << "[startup] critical path:";
+    for (auto it = path.rbegin(); it != path.rend(); ++it)
+    {
+        out << (it == path.rbegin() ? " " : " -> ") << stages[*it].name;
+    }
+    out << ", " << Milliseconds(graphEnd - graphStart) << " ms wall, " << stageSum << " ms if run one after another" << std::endl;
+}
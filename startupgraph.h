@@ -0,0 +1,78 @@
+//---------------------Parallel startup stages with dependencies---------------------------
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <initializer_list>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Startup work split into named stages, each started on its own thread as soon as the stages it
+// depends on have finished. A stage returns false to fail, stages depending on it are skipped.
+// The main thread keeps polling the window while the graph runs, so it can draw a loading state.
+class StartupGraph
+{
+public:
+    enum StageState
+    {
+        StagePending,
+        StageRunning,
+        StageDone,
+        StageFailed,
+        StageSkipped
+    };
+
+    StartupGraph() = default;
+    ~StartupGraph();
+
+    StartupGraph(const StartupGraph&) = delete;
+    StartupGraph& operator=(const StartupGraph&) = delete;
+
+    // Dependencies are ids returned by earlier calls, add every stage before Start
+    int Add(const std::string& name, std::function<bool()> task, std::initializer_list<int> dependencies = {});
+
+    void Start();
+
+    // Any thread
+    bool IsFinished() const;
+    int GetStageCount() const { return static_cast<int>(stages.size()); }
+    StageState GetState(int stage) const;
+    const std::string& GetName(int stage) const { return stages[stage].name; }
+
+    // Blocks until every stage has finished or been skipped, true when all succeeded
+    bool Wait();
+
+    // Per stage start and duration, and the chain of stages that decided the total time
+    void Report(std::ostream& out) const;
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    struct Stage
+    {
+        std::string name;
+        std::function<bool()> task;
+        std::vector<int> dependencies;
+        StageState state = StagePending;
+        Clock::time_point start;
+        Clock::time_point end;
+    };
+
+    // Called with the lock held
+    void LaunchReady();
+    void Run(int stage);
+
+    std::vector<Stage> stages;
+    std::vector<std::thread> threads;
+    bool started = false;
+    int finishedCount = 0;
+    Clock::time_point graphStart;
+    Clock::time_point graphEnd;
+
+    mutable std::mutex mutex;
+    std::condition_variable finished;
+};
@@ -1,16 +1,66 @@
 //---------------------OOP Interface for steam audio(not implemented fully yet)---------------------------
 #include "steamaudiomanager.h"
+#include "mappedfile.h"
+#include <atomic>
+#include <chrono>
 #include <iostream>
 
+namespace
+{
+    using StartupClock = std::chrono::steady_clock;
+
+    void LogStartupStage(const char* stage, StartupClock::time_point& stageStart)
+    {
+        StartupClock::time_point now = StartupClock::now();
+        std::chrono::duration<double, std::milli> elapsed = now - stageStart;
+        std::cout << "[startup] " << stage << ": " << elapsed.count() << " ms" << std::endl;
+        stageStart = now;
+    }
+
+    std::atomic<AudioAllocator*> customAllocator{ nullptr };
+    std::atomic<int> liveContexts{ 0 };
+
+    AudioAllocator& ActiveAllocator()
+    {
+        AudioAllocator* allocator = customAllocator.load(std::memory_order_acquire);
+        return allocator ? *allocator : SteamAudioManager::GetDefaultAllocator();
+    }
+
+    // Steam Audio's callbacks carry no user pointer, so they route through the process wide allocator
+    void* IPLCALL SteamAudioAllocate(IPLsize size, IPLsize alignment)
+    {
+        return ActiveAllocator().Allocate(size, alignment);
+    }
+
+    void IPLCALL SteamAudioFree(void* block)
+    {
+        ActiveAllocator().Free(block);
+    }
+
+    IPLSIMDLevel ParseSimdLevel(const std::string& name)
+    {
+        if (name == "sse2") return IPL_SIMDLEVEL_SSE2;
+        if (name == "sse4") return IPL_SIMDLEVEL_SSE4;
+        if (name == "avx") return IPL_SIMDLEVEL_AVX;
+        if (name == "avx2") return IPL_SIMDLEVEL_AVX2;
+        if (name != "avx512")
+            std::cerr << "Unknown SIMD level " << name << ", using avx512" << std::endl;
+        return IPL_SIMDLEVEL_AVX512;
+    }
+}
+
 SteamAudioManager::SteamAudioManager() : 
     context(nullptr), 
     contextSettings({}), 
+    audioSettings({}), 
     hrtf(nullptr), 
+    hrtfSettings({}),
+    simulator(nullptr),
     binauralEffect(nullptr),
     binauralEffectSettings({}), 
-    audioSettings({}), 
-    hrtfSettings({}),
+    directEffect(nullptr),
     inBuffer({}),
+    directBuffer({}),
     outBuffer({})
 {
     std::cout << "SteamAudioManager constructor called" << std::endl;
@@ -22,22 +72,97 @@ SteamAudioManager::~SteamAudioManager()
     CleanUp();
 }
 
-void SteamAudioManager::Initialize()
+bool SteamAudioManager::Initialize(const AudioConfig& config, const std::string& sofaFile)
 {
+    StartupClock::time_point initStart = StartupClock::now();
+    StartupClock::time_point stageStart = initStart;
+
+    // Zeroed settings would cap Steam Audio at SSE2, ask for the configured level instead
     contextSettings.version = STEAMAUDIO_VERSION;
-    iplContextCreate(&contextSettings, &context);
+    contextSettings.allocateCallback = SteamAudioAllocate;
+    contextSettings.freeCallback = SteamAudioFree;
+    contextSettings.simdLevel = ParseSimdLevel(config.simdLevel);
+    if (config.memoryCapBytes > 0)
+        GetDefaultAllocator().SetCap(config.memoryCapBytes);
+    if (iplContextCreate(&contextSettings, &context) != IPL_STATUS_SUCCESS)
+    {
+        std::cerr << "Failed to create Steam Audio context." << std::endl;
+        context = nullptr;
+        return false;
+    }
+    liveContexts.fetch_add(1, std::memory_order_relaxed);
+    LogStartupStage("context", stageStart);
 
-    audioSettings.samplingRate = 44100;
-    audioSettings.frameSize = 1024;
+    audioSettings.samplingRate = config.samplingRate;
+    audioSettings.frameSize = config.frameSize;
 
     hrtfSettings.type = IPL_HRTFTYPE_DEFAULT;
     hrtfSettings.volume = 1.0f;
 
-    iplHRTFCreate(context, &audioSettings, &hrtfSettings, &hrtf);
+    // Steam Audio parses the SOFA from memory, the mapping saves reading it into a buffer first
+    // and only has to outlive iplHRTFCreate, which keeps its own copy
+    MappedFile sofaMapping;
+    if (!sofaFile.empty())
+    {
+        if (sofaMapping.Open(sofaFile))
+        {
+            hrtfSettings.type = IPL_HRTFTYPE_SOFA;
+            hrtfSettings.sofaData = sofaMapping.Data();
+            hrtfSettings.sofaDataSize = static_cast<int>(sofaMapping.Size());
+            std::cout << "SOFA HRTF " << sofaFile << std::endl;
+        }
+        else
+        {
+            std::cerr << "Failed to map HRTF file: " << sofaFile << std::endl;
+            std::cerr << "Falling back to the default HRTF." << std::endl;
+        }
+        LogStartupStage("hrtf load", stageStart);
+    }
+
+    IPLerror error = iplHRTFCreate(context, &audioSettings, &hrtfSettings, &hrtf);
+    if (error != IPL_STATUS_SUCCESS && hrtfSettings.type == IPL_HRTFTYPE_SOFA)
+    {
+        std::cerr << "Failed to create SOFA HRTF, falling back to the default HRTF." << std::endl;
+        hrtfSettings = {};
+        hrtfSettings.type = IPL_HRTFTYPE_DEFAULT;
+        hrtfSettings.volume = 1.0f;
+        error = iplHRTFCreate(context, &audioSettings, &hrtfSettings, &hrtf);
+    }
+    hrtfSettings.sofaData = nullptr;
+    hrtfSettings.sofaDataSize = 0;
+    if (error != IPL_STATUS_SUCCESS)
+    {
+        std::cerr << "Failed to create the default HRTF." << std::endl;
+        hrtf = nullptr;
+        return false;
+    }
+    LogStartupStage("hrtf create", stageStart);
 
     binauralEffectSettings.hrtf = hrtf;
 
-    iplBinauralEffectCreate(context, &audioSettings, &binauralEffectSettings, &binauralEffect);
+    if (iplBinauralEffectCreate(context, &audioSettings, &binauralEffectSettings, &binauralEffect) != IPL_STATUS_SUCCESS)
+    {
+        std::cerr << "Failed to create Steam Audio binaural effect." << std::endl;
+        binauralEffect = nullptr;
+        return false;
+    }
+    LogStartupStage("binaural effect", stageStart);
+
+    // Mono direct path ahead of the binaural stage, carries occlusion and transmission
+    IPLDirectEffectSettings directEffectSettings{};
+    directEffectSettings.numChannels = 1;
+    if (iplDirectEffectCreate(context, &audioSettings, &directEffectSettings, &directEffect) != IPL_STATUS_SUCCESS)
+    {
+        std::cerr << "Failed to create Steam Audio direct effect." << std::endl;
+        directEffect = nullptr;
+        return false;
+    }
+    iplAudioBufferAllocate(context, 1, audioSettings.frameSize, &directBuffer);
+    iplAudioBufferAllocate(context, 2, audioSettings.frameSize, &outBuffer);
+    LogStartupStage("direct effect", stageStart);
+
+    LogStartupStage("Initialize total", initStart);
+    return true;
 }
 
 void SteamAudioManager::CleanUp()
@@ -50,6 +175,11 @@ void SteamAudioManager::CleanUp()
         std::cout << "Simulator released" << std::endl;
 
     }
+    if (directEffect)
+    {
+        iplDirectEffectRelease(&directEffect);
+        std::cout << "Direct effect released" << std::endl;
+    }
     if (binauralEffect)
     {
         iplBinauralEffectRelease(&binauralEffect);
@@ -62,10 +192,17 @@ void SteamAudioManager::CleanUp()
     }
     if(context)
     {
+        iplAudioBufferFree(context, &directBuffer);
         iplAudioBufferFree(context, &outBuffer);
         iplContextRelease(&context);
         context = nullptr;
         std::cout << "Steam Audio context destroyed" << std::endl;
+
+        // With every context gone anything still live in the pool is a leak
+        AllocatorStats stats = GetDefaultAllocator().GetStats();
+        bool lastContext = liveContexts.fetch_sub(1, std::memory_order_relaxed) == 1;
+        if (lastContext && stats.liveBlocks > 0 && !customAllocator.load(std::memory_order_acquire))
+            std::cerr << "Steam Audio leaked " << stats.liveBytes << " bytes in " << stats.liveBlocks << " blocks" << std::endl;
     } 
     else
     {
@@ -81,6 +218,19 @@ void SteamAudioManager::DebugPrint() const
               << STEAMAUDIO_VERSION_MAJOR << "."
               << STEAMAUDIO_VERSION_MINOR << "."
               << STEAMAUDIO_VERSION_PATCH << std::endl;
+    std::cout << "Steam Audio memory: ";
+    GetDefaultAllocator().Report(std::cout);
+}
+
+void SteamAudioManager::SetAllocator(AudioAllocator* allocator)
+{
+    customAllocator.store(allocator, std::memory_order_release);
+}
+
+PoolAllocator& SteamAudioManager::GetDefaultAllocator()
+{
+    static PoolAllocator pool;
+    return pool;
 }
 
 IPLSource SteamAudioManager::CreateSource()
@@ -98,7 +248,7 @@ IPLSource SteamAudioManager::CreateSource()
     return source;
 }
 
-std::vector<float> SteamAudioManager::ProcessAudio(std::vector<float>& vectorBuffer, IPLVector3& dirVector)
+std::vector<float> SteamAudioManager::ProcessAudio(const std::vector<float>& vectorBuffer, const IPLVector3& dirVector, float occlusion, float transmission)
 {
     // Prepare audio buffers
     std::vector<float> inputBuffer(vectorBuffer.begin(), vectorBuffer.end());
@@ -109,18 +259,26 @@ std::vector<float> SteamAudioManager::ProcessAudio(std::vector<float>& vectorBuf
     float* inData[] = { inputBuffer.data() };
     inBuffer.data = inData;
 
-    iplAudioBufferAllocate(context, 2, audioSettings.frameSize, &outBuffer);
+    IPLDirectEffectParams directParams{};
+    directParams.flags = static_cast<IPLDirectEffectFlags>(IPL_DIRECTEFFECTFLAGS_APPLYOCCLUSION | IPL_DIRECTEFFECTFLAGS_APPLYTRANSMISSION);
+    directParams.transmissionType = IPL_TRANSMISSIONTYPE_FREQINDEPENDENT;
+    directParams.occlusion = occlusion;
+    directParams.transmission[0] = transmission;
+    directParams.transmission[1] = transmission;
+    directParams.transmission[2] = transmission;
 
     size_t numFrames = inputBuffer.size() / audioSettings.frameSize;
     for (size_t frame = 0; frame < numFrames; ++frame)
     {
+        iplDirectEffectApply(directEffect, &directParams, &inBuffer, &directBuffer);
+
         IPLBinauralEffectParams params{};
         params.direction = dirVector; 
         params.hrtf = hrtf;
         params.interpolation = IPL_HRTFINTERPOLATION_NEAREST;
         params.spatialBlend = 1.0f;
 
-        iplBinauralEffectApply(binauralEffect, &params, &inBuffer, &outBuffer);
+        iplBinauralEffectApply(binauralEffect, &params, &directBuffer, &outBuffer);
 
         iplAudioBufferInterleave(context, &outBuffer, outputBuffer.data() + frame * audioSettings.frameSize * 2);
 
@@ -128,3 +286,72 @@ std::vector<float> SteamAudioManager::ProcessAudio(std::vector<float>& vectorBuf
     }
     return outputBuffer;
 }
+
+bool SteamAudioManager::CreateVoice(SteamAudioVoice& voice)
+{
+    IPLDirectEffectSettings directEffectSettings{};
+    directEffectSettings.numChannels = 1;
+
+    IPLBinauralEffectSettings voiceBinauralSettings{};
+    voiceBinauralSettings.hrtf = hrtf;
+
+    if (iplDirectEffectCreate(context, &audioSettings, &directEffectSettings, &voice.directEffect) != IPL_STATUS_SUCCESS ||
+        iplBinauralEffectCreate(context, &audioSettings, &voiceBinauralSettings, &voice.binauralEffect) != IPL_STATUS_SUCCESS)
+    {
+        std::cerr << "Failed to create Steam Audio voice." << std::endl;
+        ReleaseVoice(voice);
+        return false;
+    }
+
+    iplAudioBufferAllocate(context, 1, audioSettings.frameSize, &voice.directBuffer);
+    iplAudioBufferAllocate(context, 2, audioSettings.frameSize, &voice.outBuffer);
+    return true;
+}
+
+void SteamAudioManager::ReleaseVoice(SteamAudioVoice& voice)
+{
+    if (voice.directEffect)
+        iplDirectEffectRelease(&voice.directEffect);
+    if (voice.binauralEffect)
+        iplBinauralEffectRelease(&voice.binauralEffect);
+    if (voice.directBuffer.data)
+        iplAudioBufferFree(context, &voice.directBuffer);
+    if (voice.outBuffer.data)
+        iplAudioBufferFree(context, &voice.outBuffer);
+    voice = SteamAudioVoice{};
+}
+
+void SteamAudioManager::ResetVoice(SteamAudioVoice& voice)
+{
+    iplDirectEffectReset(voice.directEffect);
+    iplBinauralEffectReset(voice.binauralEffect);
+}
+
+void SteamAudioManager::ProcessBlock(SteamAudioVoice& voice, const float* input, float* interleavedOutput, const IPLVector3& direction,
+                                     float occlusion, float transmission, IPLHRTFInterpolation interpolation)
+{
+    // Steam Audio only reads the input, wrapping the caller's samples avoids a copy
+    float* inData[] = { const_cast<float*>(input) };
+    IPLAudioBuffer voiceInBuffer{};
+    voiceInBuffer.numChannels = 1;
+    voiceInBuffer.numSamples = audioSettings.frameSize;
+    voiceInBuffer.data = inData;
+
+    IPLDirectEffectParams directParams{};
+    directParams.flags = static_cast<IPLDirectEffectFlags>(IPL_DIRECTEFFECTFLAGS_APPLYOCCLUSION | IPL_DIRECTEFFECTFLAGS_APPLYTRANSMISSION);
+    directParams.transmissionType = IPL_TRANSMISSIONTYPE_FREQINDEPENDENT;
+    directParams.occlusion = occlusion;
+    directParams.transmission[0] = transmission;
+    directParams.transmission[1] = transmission;
+    directParams.transmission[2] = transmission;
+    iplDirectEffectApply(voice.directEffect, &directParams, &voiceInBuffer, &voice.directBuffer);
+
+    IPLBinauralEffectParams params{};
+    params.direction = direction;
+    params.hrtf = hrtf;
+    params.interpolation = interpolation;
+    params.spatialBlend = 1.0f;
+    iplBinauralEffectApply(voice.binauralEffect, &params, &voice.directBuffer, &voice.outBuffer);
+
+    iplAudioBufferInterleave(context, &voice.outBuffer, interleavedOutput);
+}
@@ -3,20 +3,53 @@
 
 #include <SFML/Audio.hpp>
 #include "phonon.h"
+#include "audioconfig.h"
+#include "poolallocator.h"
+#include <string>
 #include <vector>
 
+// Per-voice effect chain, effects carry filter state so every playing voice needs its own
+struct SteamAudioVoice
+{
+    IPLDirectEffect directEffect = nullptr;
+    IPLBinauralEffect binauralEffect = nullptr;
+    IPLAudioBuffer directBuffer{};
+    IPLAudioBuffer outBuffer{};
+};
+
 class SteamAudioManager
 {
 public:
     SteamAudioManager();
     ~SteamAudioManager();
 
-    void Initialize();
+    // Rate and frame size come from config, empty sofaFile selects the built-in Steam Audio HRTF.
+    // A SOFA that fails to load falls back to the built-in HRTF, false means no usable effects.
+    bool Initialize(const AudioConfig& config, const std::string& sofaFile = "");
     void CleanUp();
     void DebugPrint() const;
 
     IPLSource CreateSource();
-    std::vector<float> ProcessAudio(std::vector<float>& vectorBuffer, IPLVector3& dirVector);
+
+    // Every context allocates through this, set before the first Initialize and keep alive past the last CleanUp.
+    // nullptr goes back to the built-in pool.
+    static void SetAllocator(AudioAllocator* allocator);
+    static PoolAllocator& GetDefaultAllocator();
+
+    bool CreateVoice(SteamAudioVoice& voice);
+    void ReleaseVoice(SteamAudioVoice& voice);
+    void ResetVoice(SteamAudioVoice& voice);
+
+    // Exactly one frame: frameSize mono samples in, frameSize interleaved stereo frames out.
+    // Bilinear HRTF interpolation is smoother for moving sources and costs more than nearest.
+    void ProcessBlock(SteamAudioVoice& voice, const float* input, float* interleavedOutput, const IPLVector3& direction,
+                      float occlusion = 1.0f, float transmission = 1.0f, IPLHRTFInterpolation interpolation = IPL_HRTFINTERPOLATION_NEAREST);
+
+    int GetSamplingRate() const { return audioSettings.samplingRate; }
+    int GetFrameSize() const { return audioSettings.frameSize; }
+
+    // occlusion and transmission come from the occluder grid, 1 means unobstructed
+    std::vector<float> ProcessAudio(const std::vector<float>& vectorBuffer, const IPLVector3& dirVector, float occlusion = 1.0f, float transmission = 1.0f);
 
 private:
     IPLContext context;
@@ -27,7 +60,9 @@ private:
     IPLSimulator simulator;
     IPLBinauralEffect binauralEffect;
     IPLBinauralEffectSettings binauralEffectSettings;
+    IPLDirectEffect directEffect;
 
     IPLAudioBuffer inBuffer;
+    IPLAudioBuffer directBuffer;
     IPLAudioBuffer outBuffer;
 };
\ No newline at end of file
@@ -0,0 +1,135 @@
+//---------------------Hierarchical timing wheel for sample-timed events---------------------------
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Four levels of 256 slots. Level 0 holds events due within the current 256 tick window, one
+// tick per slot. Each level above covers 256 times the span of the one below and is cascaded
+// down when the window below it wraps. Schedule and expiry are O(1). An event moves down at most
+// three times over its life. Nodes come from a fixed pool, so nothing allocates after construction.
+template <typename T>
+class TimingWheel
+{
+public:
+    static constexpr int levelBits = 8;
+    static constexpr int levelCount = 4;
+    static constexpr std::uint32_t slotCount = 1u << levelBits;
+
+    // Longest delay Schedule accepts, ticks beyond it would wrap the top level
+    static constexpr std::uint64_t maxDelay = (std::uint64_t(1) << (levelBits * (levelCount - 1))) * (slotCount - 1);
+
+    explicit TimingWheel(std::size_t capacity, std::uint64_t startTick = 0) :
+        now(startTick),
+        pending(0),
+        nodes(capacity),
+        slots(std::size_t(levelCount) * slotCount, noNode)
+    {
+        for (std::size_t i = 0; i < capacity; ++i)
+        {
+            nodes[i].next = i + 1 < capacity ? static_cast<std::uint32_t>(i + 1) : noNode;
+        }
+        freeList = capacity > 0 ? 0 : noNode;
+    }
+
+    std::uint64_t GetNow() const { return now; }
+    std::size_t GetPending() const { return pending; }
+
+    // Events already due fire on the next Advance. False when the pool is full or the tick is too far out.
+    bool Schedule(std::uint64_t tick, const T& payload)
+    {
+        if (freeList == noNode || (tick > now && tick - now > maxDelay))
+            return false;
+
+        std::uint32_t index = freeList;
+        freeList = nodes[index].next;
+        nodes[index].tick = tick < now ? now : tick;
+        nodes[index].payload = payload;
+        Link(index);
+        ++pending;
+        return true;
+    }
+
+    // Fires fire(tick, payload) for every event due before until, in tick order, and moves now to until
+    template <typename Fire>
+    void Advance(std::uint64_t until, Fire&& fire)
+    {
+        while (now < until)
+        {
+            // Nothing left anywhere, skip straight to the end
+            if (pending == 0)
+            {
+                now = until;
+                return;
+            }
+
+            std::uint32_t& head = slots[now & (slotCount - 1)];
+            std::uint32_t index = head;
+            head = noNode;
+            while (index != noNode)
+            {
+                std::uint32_t next = nodes[index].next;
+                fire(nodes[index].tick, nodes[index].payload);
+                nodes[index].next = freeList;
+                freeList = index;
+                --pending;
+                index = next;
+            }
+
+            ++now;
+            // Highest level first, so events it hands down are cascaded again by the levels below
+            for (int level = levelCount - 1; level > 0; --level)
+            {
+                std::uint64_t span = std::uint64_t(1) << (levelBits * level);
+                if ((now & (span - 1)) == 0)
+                    Cascade(level);
+            }
+        }
+    }
+
+private:
+    static constexpr std::uint32_t noNode = 0xffffffffu;
+
+    struct Node
+    {
+        std::uint64_t tick = 0;
+        std::uint32_t next = noNode;
+        T payload {};
+    };
+
+    // The level is the highest 8 bit group in which tick and now differ, so an event always sits
+    // in a slot that comes round before it is due
+    void Link(std::uint32_t index)
+    {
+        std::uint64_t tick = nodes[index].tick;
+        std::uint64_t difference = tick ^ now;
+        int level = 0;
+        while (level < levelCount - 1 && (difference >> (levelBits * (level + 1))) != 0)
+        {
+            ++level;
+        }
+        std::uint32_t& head = slots[std::size_t(level) * slotCount + ((tick >> (levelBits * level)) & (slotCount - 1))];
+        nodes[index].next = head;
+        head = index;
+    }
+
+    void Cascade(int level)
+    {
+        std::uint32_t& head = slots[std::size_t(level) * slotCount + ((now >> (levelBits * level)) & (slotCount - 1))];
+        std::uint32_t index = head;
+        head = noNode;
+        while (index != noNode)
+        {
+            std::uint32_t next = nodes[index].next;
+            Link(index);
+            index = next;
+        }
+    }
+
+    std::uint64_t now;
+    std::size_t pending;
+    std::uint32_t freeList;
+    std::vector<Node> nodes;
+    std::vector<std::uint32_t> slots;
+};
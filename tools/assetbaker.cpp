@@ -0,0 +1,117 @@
+//---------------------Offline asset baker, packs loose assets into one mapped bundle---------------------------
+#include "../assetbundle.h"
+#include "../audioasset.h"
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+namespace
+{
+    struct BakeItem
+    {
+        std::string name;
+        std::string path;
+        bool audio;
+    };
+
+    bool ReadBytes(const std::string& path, std::vector<std::uint8_t>& bytes)
+    {
+        std::ifstream in(path, std::ios::binary);
+        if (!in)
+            return false;
+        bytes.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+        return true;
+    }
+
+    // Whole positive numbers only, std::stoi would throw on a typo
+    bool ParseRate(const char* text, int& rate)
+    {
+        char* end = nullptr;
+        long parsed = std::strtol(text, &end, 10);
+        if (end == text || *end != '\0' || parsed <= 0 || parsed > 1000000)
+            return false;
+        rate = static_cast<int>(parsed);
+        return true;
+    }
+
+    // "name=path" on the command line
+    bool ParseItem(const std::string& spec, bool audio, BakeItem& item)
+    {
+        std::size_t split = spec.find('=');
+        if (split == std::string::npos || split == 0)
+            return false;
+        item = { spec.substr(0, split), spec.substr(split + 1), audio };
+        return true;
+    }
+
+    void PrintUsage()
+    {
+        std::cout << "usage: assetbaker [--out file] [--rate hz] [--audio name=path]... [--blob name=path]...\n"
+                  << "without --audio/--blob the game's default assets are baked\n";
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    std::string outPath = "assets/assets.bundle";
+    int samplingRate = 44100;
+    std::vector<BakeItem> items;
+
+    for (int i = 1; i < argc; ++i)
+    {
+        std::string arg = argv[i];
+        BakeItem item;
+        if (arg == "--out" && i + 1 < argc)
+            outPath = argv[++i];
+        else if (arg == "--rate" && i + 1 < argc && ParseRate(argv[++i], samplingRate))
+            continue;
+        else if (arg == "--audio" && i + 1 < argc && ParseItem(argv[++i], true, item))
+            items.push_back(item);
+        else if (arg == "--blob" && i + 1 < argc && ParseItem(argv[++i], false, item))
+            items.push_back(item);
+        else
+        {
+            PrintUsage();
+            return 1;
+        }
+    }
+
+    // Same names main() looks up
+    if (items.empty())
+    {
+        items.push_back({ "radar", "assets/audiofiles/radarSFX.wav", true });
+        items.push_back({ "font", "assets/fonts/ARIAL.TTF", false });
+    }
+
+    AssetBundleWriter writer(samplingRate);
+    for (const BakeItem& item : items)
+    {
+        if (item.audio)
+        {
+            std::vector<float> samples;
+            if (!LoadMonoSamples(item.path, samplingRate, samples))
+                return 1;
+            std::cout << "audio " << item.name << ": " << samples.size() << " samples at " << samplingRate << " Hz" << std::endl;
+            writer.AddAudio(item.name, std::move(samples), item.path);
+        }
+        else
+        {
+            std::vector<std::uint8_t> bytes;
+            if (!ReadBytes(item.path, bytes))
+            {
+                std::cerr << "Failed to read asset: " << item.path << std::endl;
+                return 1;
+            }
+            std::cout << "blob " << item.name << ": " << bytes.size() << " bytes" << std::endl;
+            writer.AddBlob(item.name, std::move(bytes), item.path);
+        }
+    }
+
+    if (!writer.Write(outPath))
+        return 1;
+    std::cout << "wrote " << outPath << std::endl;
+    return 0;
+}